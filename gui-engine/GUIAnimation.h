@@ -0,0 +1,232 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+namespace gui
+{
+	// Frames laid out left to right, top to bottom inside one texture
+	// region, usually an atlas entry. One frame with no frame time is a
+	// plain static image.
+	struct SpriteSheet
+	{
+		sf::Vector2i frame_size;
+		std::uint32_t frame_count = 1;
+		// 0 fits as many columns as the region is wide
+		std::uint32_t columns = 0;
+		float frame_time = 0;
+		bool loop = true;
+
+		static SpriteSheet grid(sf::Vector2i frame_size, std::uint32_t frame_count, float fps, bool loop = true)
+		{
+			return { frame_size, frame_count, 0, fps > 0 ? 1 / fps : 0, loop };
+		}
+
+		bool isAnimated() const
+		{
+			return frame_count > 1 and frame_time > 0;
+		}
+
+		// `region` is where the sheet currently lives; it moves if the atlas
+		// evicts and reloads it, so frames are resolved on every switch.
+		sf::IntRect getFrame(const sf::IntRect& region, std::uint32_t frame) const
+		{
+			if (frame_size.x <= 0 or frame_size.y <= 0)
+			{
+				return region;
+			}
+
+			std::uint32_t per_row = columns > 0 ? columns : std::uint32_t(std::max(1, region.width / frame_size.x));
+			return sf::IntRect(region.left + int(frame % per_row) * frame_size.x, region.top + int(frame / per_row) * frame_size.y, frame_size.x, frame_size.y);
+		}
+	};
+
+	// A widget that shows sprite-sheet frames. setAnimationFrame is only
+	// called when the frame actually changes, and must not start or stop
+	// animations itself.
+	class IAnimated
+	{
+	private:
+
+		friend class AnimationSystem;
+
+		bool playing_ = false;
+
+	protected:
+
+		IAnimated()
+		{
+
+		}
+
+		IAnimated(const IAnimated&)
+		{
+
+		}
+
+		IAnimated& operator=(const IAnimated&)
+		{
+			return *this;
+		}
+
+		~IAnimated();
+
+	public:
+
+		virtual void setAnimationFrame(std::uint32_t frame) = 0;
+
+	};
+
+	// Advances every playing sprite-sheet animation in one pass per frame.
+	// The clocks live in flat arrays next to each other; a widget is only
+	// called back when its frame index changes, and with nothing playing
+	// update() does no work at all.
+	class AnimationSystem
+	{
+	private:
+
+		std::vector<float> elapsed_;
+		std::vector<float> frame_time_;
+		std::vector<std::uint32_t> frame_count_;
+		std::vector<std::uint32_t> frame_;
+		std::vector<std::uint8_t> loop_;
+		std::vector<IAnimated*> target_;
+
+		std::unordered_map<const IAnimated*, std::size_t> index_;
+
+		AnimationSystem()
+		{
+
+		}
+
+		void remove(std::size_t index)
+		{
+			std::size_t last = target_.size() - 1;
+			target_[index]->playing_ = false;
+			index_.erase(target_[index]);
+
+			if (index != last)
+			{
+				elapsed_[index] = elapsed_[last];
+				frame_time_[index] = frame_time_[last];
+				frame_count_[index] = frame_count_[last];
+				frame_[index] = frame_[last];
+				loop_[index] = loop_[last];
+				target_[index] = target_[last];
+				index_[target_[index]] = index;
+			}
+
+			elapsed_.pop_back();
+			frame_time_.pop_back();
+			frame_count_.pop_back();
+			frame_.pop_back();
+			loop_.pop_back();
+			target_.pop_back();
+		}
+
+	public:
+
+		static AnimationSystem& get()
+		{
+			static AnimationSystem system;
+			return system;
+		}
+
+		// Starts `sheet` on `target` from its first frame, replacing whatever
+		// the target was playing. A static sheet just stops it.
+		void play(IAnimated* target, const SpriteSheet& sheet)
+		{
+			stop(target);
+			target->setAnimationFrame(0);
+			if (!sheet.isAnimated())
+			{
+				return;
+			}
+
+			index_[target] = target_.size();
+			elapsed_.push_back(0);
+			frame_time_.push_back(sheet.frame_time);
+			frame_count_.push_back(sheet.frame_count);
+			frame_.push_back(0);
+			loop_.push_back(sheet.loop);
+			target_.push_back(target);
+			target->playing_ = true;
+		}
+
+		// Leaves the target on the frame it is showing.
+		void stop(const IAnimated* target)
+		{
+			if (target->playing_)
+			{
+				remove(index_[target]);
+			}
+		}
+
+		bool isPlaying(const IAnimated* target) const
+		{
+			return target->playing_;
+		}
+
+		void update(float seconds)
+		{
+			std::size_t n = target_.size();
+			if (n == 0)
+			{
+				return;
+			}
+
+			float* elapsed = elapsed_.data();
+			const float* frame_time = frame_time_.data();
+			const std::uint32_t* frame_count = frame_count_.data();
+			std::uint32_t* frame = frame_.data();
+
+			for (std::size_t i = 0; i < n; i++)
+			{
+				elapsed[i] += seconds;
+
+				// wrap the clock so it keeps its precision on long loops
+				float period = frame_time[i] * frame_count[i];
+				if (loop_[i] and elapsed[i] >= period)
+				{
+					elapsed[i] -= period * std::uint32_t(elapsed[i] / period);
+				}
+			}
+
+			for (std::size_t i = 0; i < n; i++)
+			{
+				std::uint32_t next = std::min(std::uint32_t(elapsed[i] / frame_time[i]), frame_count[i] - 1);
+				if (next != frame[i])
+				{
+					frame[i] = next;
+					target_[i]->setAnimationFrame(next);
+				}
+			}
+
+			// one-shot animations stay on their last frame
+			for (std::size_t i = n; i-- > 0;)
+			{
+				if (!loop_[i] and elapsed_[i] >= frame_time_[i] * frame_count_[i])
+				{
+					remove(i);
+				}
+			}
+		}
+
+		std::size_t getCount() const
+		{
+			return target_.size();
+		}
+
+	};
+
+	inline IAnimated::~IAnimated()
+	{
+		if (playing_)
+		{
+			AnimationSystem::get().stop(this);
+		}
+	}
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "GUIAtlas.h"
+#include "GUIResourcePack.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace gui
+{
+	class IAssetListener
+	{
+	protected:
+
+		IAssetListener()
+		{
+
+		}
+
+	public:
+
+		// Called on the render thread whenever an asset the listener uses
+		// becomes ready to draw, including after an evicted texture has been
+		// reloaded.
+		virtual void assetReady() = 0;
+
+	};
+
+	// Decodes images and parses fonts on a pool of worker threads, so
+	// constructing widgets never waits on the disk. Finished images are
+	// uploaded into the shared TextureAtlas by pump(), a few rows per call,
+	// on the thread that owns the GL context. Everything but the decoding
+	// itself happens on that thread, including the listener callbacks.
+	//
+	// Textures are also kept under a byte budget. Widgets touch() the
+	// textures they draw; when the atlas grows past the budget, the pages
+	// drawn least recently are released and their images reloaded the next
+	// time something touches them. A page is the unit of eviction because
+	// the images on it share one GL texture.
+	class AssetLoader
+	{
+	public:
+
+		struct Asset
+		{
+			std::string path;
+			bool ready = false;
+			bool failed = false;
+
+			// Calls `listener` right away when the asset is ready already.
+			void addListener(IAssetListener* listener)
+			{
+				listeners_.push_back(listener);
+				if (ready)
+				{
+					listener->assetReady();
+				}
+			}
+
+			void removeListener(IAssetListener* listener)
+			{
+				listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener), listeners_.end());
+			}
+
+		private:
+
+			friend class AssetLoader;
+
+			std::vector<IAssetListener*> listeners_;
+			bool loading_ = false;
+
+		};
+
+		// `font` may only be touched once `ready` is set.
+		struct FontAsset : Asset
+		{
+			sf::Font font;
+		};
+
+		struct TextureAsset : Asset
+		{
+			TextureAtlas::Region region;
+
+		private:
+
+			friend class AssetLoader;
+
+			// decoded image, or null when pixels_ point into a mapped pack
+			std::unique_ptr<sf::Image> image_;
+			const sf::Uint8* pixels_ = nullptr;
+			sf::Vector2u size_;
+			unsigned int uploaded_rows_ = 0;
+
+			std::uint64_t last_used_ = 0;
+
+		};
+
+		using Font = std::shared_ptr<FontAsset>;
+		using Texture = std::shared_ptr<TextureAsset>;
+
+		struct TextureStats
+		{
+			std::size_t resident_bytes = 0;
+			std::size_t evicted_bytes = 0;
+			std::size_t evictions = 0;
+			std::size_t reloads = 0;
+		};
+
+	private:
+
+		std::unordered_map<std::string, Font> fonts_;
+		std::unordered_map<std::string, Texture> textures_;
+		std::vector<const ResourcePack*> packs_;
+
+		std::vector<std::thread> workers_;
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		std::deque<std::function<void()>> jobs_;
+		std::vector<std::function<void()>> finished_;
+		bool stopping_;
+
+		// render thread only
+		std::deque<Texture> uploads_;
+		std::size_t upload_budget_;
+		std::size_t pending_;
+		TextureAtlas::Region placeholder_;
+
+		std::size_t texture_budget_;
+		std::uint64_t frame_;
+		TextureStats stats_;
+
+		AssetLoader() :
+			stopping_(false),
+			upload_budget_(256 * 1024),
+			pending_(0),
+			texture_budget_(64 * 1024 * 1024),
+			frame_(1)
+		{
+
+		}
+
+		void work()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (true)
+			{
+				wake_.wait(lock, [this] { return stopping_ or !jobs_.empty(); });
+				if (stopping_)
+				{
+					return;
+				}
+
+				std::function<void()> job = std::move(jobs_.front());
+				jobs_.pop_front();
+
+				lock.unlock();
+				job();
+				lock.lock();
+			}
+		}
+
+		// `job` runs on a worker; `done` runs on the render thread in pump().
+		void enqueue(std::function<void()> job, std::function<void()> done)
+		{
+			if (workers_.empty())
+			{
+				unsigned int count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+				for (unsigned int i = 0; i < count; i++)
+				{
+					workers_.emplace_back(&AssetLoader::work, this);
+				}
+			}
+
+			pending_++;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				jobs_.push_back([this, job = std::move(job), done = std::move(done)]() mutable
+				{
+					job();
+					std::lock_guard<std::mutex> lock(mutex_);
+					finished_.push_back(std::move(done));
+				});
+			}
+			wake_.notify_one();
+		}
+
+		const ResourcePack::Entry* findPacked(std::string_view path) const
+		{
+			for (auto pack : packs_)
+			{
+				if (const ResourcePack::Entry* entry = pack->find(path))
+				{
+					return entry;
+				}
+			}
+			return nullptr;
+		}
+
+		static void finish(Asset& asset, bool loaded)
+		{
+			asset.ready = loaded;
+			asset.failed = !loaded;
+			asset.loading_ = false;
+
+			if (loaded)
+			{
+				// a listener may remove itself from inside the callback
+				std::vector<IAssetListener*> listeners = asset.listeners_;
+				for (auto listener : listeners)
+				{
+					listener->assetReady();
+				}
+			}
+		}
+
+		// Reads the image from a mounted pack or its file and queues the
+		// upload; used for the first load and after an eviction.
+		void request(const Texture& texture)
+		{
+			texture->loading_ = true;
+
+			const ResourcePack::Entry* entry = findPacked(texture->path);
+			if (entry != nullptr and entry->type == ResourcePack::Type::Rgba)
+			{
+				// nothing to decode, the upload reads the mapped pixels
+				texture->pixels_ = entry->data;
+				texture->size_ = { entry->width, entry->height };
+				texture->uploaded_rows_ = 0;
+				uploads_.push_back(texture);
+				return;
+			}
+
+			auto image = std::make_shared<std::unique_ptr<sf::Image>>(std::make_unique<sf::Image>());
+			enqueue([image, path = texture->path, entry]
+			{
+				bool loaded = entry != nullptr ? (*image)->loadFromMemory(entry->data, entry->size) : (*image)->loadFromFile(path);
+				if (!loaded)
+				{
+					image->reset();
+				}
+			},
+			[this, texture, image]
+			{
+				if (*image == nullptr)
+				{
+					finish(*texture, false);
+					return;
+				}
+				texture->image_ = std::move(*image);
+				texture->pixels_ = texture->image_->getPixelsPtr();
+				texture->size_ = texture->image_->getSize();
+				texture->uploaded_rows_ = 0;
+				uploads_.push_back(texture);
+			});
+		}
+
+		// Evicts whole atlas pages, least recently drawn first, until the
+		// atlas fits the budget. Pages drawn in the last frame or still
+		// being uploaded to are kept even when that leaves it over budget.
+		void enforceBudget()
+		{
+			TextureAtlas& atlas = TextureAtlas::get();
+			while (atlas.getResidentBytes() > texture_budget_)
+			{
+				std::vector<std::uint64_t> last_used(atlas.getPageCount(), 0);
+				for (const auto& [path, texture] : textures_)
+				{
+					std::size_t page = atlas.getPage(texture->region);
+					if (page < last_used.size())
+					{
+						std::uint64_t used = texture->loading_ ? frame_ : texture->last_used_;
+						last_used[page] = std::max(last_used[page], used);
+					}
+				}
+
+				std::size_t oldest = last_used.size();
+				for (std::size_t i = 0; i < last_used.size(); i++)
+				{
+					if (atlas.isEvictable(i) and last_used[i] + 1 < frame_ and (oldest == last_used.size() or last_used[i] < last_used[oldest]))
+					{
+						oldest = i;
+					}
+				}
+
+				if (oldest == last_used.size())
+				{
+					return;
+				}
+
+				const sf::Texture* evicted = &atlas.getPageTexture(oldest);
+				std::size_t bytes = atlas.evict(oldest);
+				stats_.evicted_bytes += bytes;
+				stats_.evictions++;
+
+				for (const auto& [path, texture] : textures_)
+				{
+					if (texture->region.texture == evicted)
+					{
+						texture->region = TextureAtlas::Region();
+						texture->ready = false;
+					}
+				}
+			}
+		}
+
+	public:
+
+		~AssetLoader()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
+			wake_.notify_all();
+
+			for (auto& worker : workers_)
+			{
+				worker.join();
+			}
+		}
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+
+		static AssetLoader& get()
+		{
+			static AssetLoader loader;
+			return loader;
+		}
+
+		// Assets found in a mounted pack are read from it instead of from
+		// loose files; the pack has to outlive everything loaded from it.
+		void mount(const ResourcePack* pack)
+		{
+			packs_.push_back(pack);
+		}
+
+		void unmount(const ResourcePack* pack)
+		{
+			packs_.erase(std::remove(packs_.begin(), packs_.end(), pack), packs_.end());
+		}
+
+		// Every caller asking for the same path shares one font.
+		Font loadFont(const std::string& path)
+		{
+			Font& font = fonts_[path];
+			if (font == nullptr)
+			{
+				font = std::make_shared<FontAsset>();
+				font->path = path;
+
+				auto loaded = std::make_shared<bool>(false);
+				const ResourcePack::Entry* entry = findPacked(path);
+				enqueue([font, loaded, entry]
+				{
+					// parsed in place from the mapping, without a copy
+					*loaded = entry != nullptr ? font->font.loadFromMemory(entry->data, entry->size) : font->font.loadFromFile(font->path);
+				},
+				[font, loaded] { finish(*font, *loaded); });
+			}
+			return font;
+		}
+
+		// Images already in the atlas (e.g. from TextureAtlas::loadPacked)
+		// are ready at once.
+		Texture loadTexture(const std::string& path)
+		{
+			Texture& texture = textures_[path];
+			if (texture == nullptr)
+			{
+				texture = std::make_shared<TextureAsset>();
+				texture->path = path;
+
+				texture->last_used_ = frame_;
+
+				if ((texture->region = TextureAtlas::get().find(path)))
+				{
+					texture->ready = true;
+					return texture;
+				}
+
+				request(texture);
+			}
+			return texture;
+		}
+
+		// Wraps a region the loader does not own, e.g. one added to the atlas
+		// directly; it is always ready and never evicted.
+		static Texture wrap(TextureAtlas::Region region)
+		{
+			auto texture = std::make_shared<TextureAsset>();
+			texture->region = region;
+			texture->ready = static_cast<bool>(region);
+			return texture;
+		}
+
+		// Marks the texture as drawn this frame. An evicted texture is queued
+		// for reloading and reported to its listeners again once it is back.
+		// Returns whether it can be drawn now.
+		bool touch(const Texture& texture)
+		{
+			texture->last_used_ = frame_;
+			if (!texture->ready and !texture->failed and !texture->loading_ and !texture->path.empty())
+			{
+				stats_.reloads++;
+				request(texture);
+			}
+			return texture->ready;
+		}
+
+		// Bytes of atlas pages kept on the GPU before the least recently
+		// drawn ones are released.
+		void setTextureBudget(std::size_t bytes)
+		{
+			texture_budget_ = bytes;
+		}
+
+		std::size_t getTextureBudget() const
+		{
+			return texture_budget_;
+		}
+
+		const TextureStats& getTextureStats()
+		{
+			stats_.resident_bytes = TextureAtlas::get().getResidentBytes();
+			return stats_;
+		}
+
+		// Small grey region widgets stretch over their area while their
+		// texture is loading.
+		const TextureAtlas::Region& getPlaceholder()
+		{
+			if (!placeholder_)
+			{
+				sf::Image image;
+				image.create(4, 4, sf::Color(90, 90, 90));
+				placeholder_ = TextureAtlas::get().add("gui/placeholder", image);
+			}
+			return placeholder_;
+		}
+
+		// Bytes of pixels pump() uploads per call at most; one row always goes.
+		void setUploadBudget(std::size_t bytes)
+		{
+			upload_budget_ = bytes;
+		}
+
+		// Runs the completion of finished jobs, uploads decoded images and
+		// evicts textures over the budget. Call once per frame from the
+		// render thread (Engine::update does).
+		void pump()
+		{
+			frame_++;
+
+			std::vector<std::function<void()>> finished;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				finished.swap(finished_);
+			}
+
+			for (auto& done : finished)
+			{
+				pending_--;
+				done();
+			}
+
+			std::size_t spent = 0;
+			while (!uploads_.empty() and spent < upload_budget_)
+			{
+				TextureAsset& texture = *uploads_.front();
+				sf::Vector2u size = texture.size_;
+
+				if (!texture.region)
+				{
+					texture.region = TextureAtlas::get().reserve(texture.path, size, false);
+				}
+
+				std::size_t row_bytes = static_cast<std::size_t>(size.x) * 4;
+				unsigned int rows = static_cast<unsigned int>(std::max<std::size_t>((upload_budget_ - spent) / std::max<std::size_t>(row_bytes, 1), 1));
+				rows = std::min(rows, size.y - texture.uploaded_rows_);
+
+				if (texture.region)
+				{
+					TextureAtlas::get().upload(texture.path, texture.pixels_, size, texture.uploaded_rows_, rows);
+				}
+				texture.uploaded_rows_ += rows;
+				spent += rows * row_bytes;
+
+				if (texture.uploaded_rows_ >= size.y)
+				{
+					texture.image_.reset();
+					texture.pixels_ = nullptr;
+					finish(texture, static_cast<bool>(texture.region));
+					uploads_.pop_front();
+				}
+			}
+
+			enforceBudget();
+		}
+
+		// True while anything is still decoding or waiting for upload.
+		bool isBusy() const
+		{
+			return pending_ > 0 or !uploads_.empty();
+		}
+
+	};
+}
@@ -0,0 +1,504 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+
+namespace gui
+{
+	// Packs small UI images into shared pages so widgets drawing them keep
+	// the same texture bound. Images are placed with a skyline packer and
+	// their border pixels are extruded into the padding, so filtering or
+	// rounding at the edge of a sub-rect never samples a neighbour.
+	class TextureAtlas
+	{
+	public:
+
+		// Where an image ended up: the page texture and the sub-rect on it.
+		struct Region
+		{
+			const sf::Texture* texture = nullptr;
+			sf::IntRect rect;
+
+			explicit operator bool() const
+			{
+				return texture != nullptr;
+			}
+
+			void applyTo(sf::Sprite& sprite) const
+			{
+				if (texture != nullptr)
+				{
+					sprite.setTexture(*texture);
+					sprite.setTextureRect(rect);
+				}
+			}
+		};
+
+	private:
+
+		struct Segment
+		{
+			int x;
+			int y;
+			int width;
+		};
+
+		struct Page
+		{
+			// kept across evict() so regions keep a valid texture pointer
+			std::unique_ptr<sf::Texture> texture;
+			sf::Vector2u size;
+			std::vector<Segment> skyline;
+			bool resident;
+			std::size_t pinned;
+		};
+
+		struct Entry
+		{
+			std::size_t page;
+			sf::IntRect rect;
+			bool pinned;
+		};
+
+		std::vector<Page> pages_;
+		std::unordered_map<std::string, Entry> entries_;
+
+		unsigned int page_size_;
+		int padding_;
+		int extrude_;
+
+		Region region(const Entry& entry) const
+		{
+			return { pages_[entry.page].texture.get(), entry.rect };
+		}
+
+		// Creates the page's texture, cleared to transparent, the first time
+		// it is allocated from after being added or evicted.
+		void makeResident(Page& page)
+		{
+			if (!page.resident)
+			{
+				page.texture->create(page.size.x, page.size.y);
+				std::vector<sf::Uint8> clear(static_cast<std::size_t>(page.size.x) * page.size.y * 4, 0);
+				page.texture->update(clear.data());
+				page.resident = true;
+			}
+		}
+
+		void addPage(unsigned int width, unsigned int height)
+		{
+			Page page;
+			page.texture = std::make_unique<sf::Texture>();
+			page.size = { width, height };
+			page.skyline.push_back({ 0, 0, static_cast<int>(width) });
+			page.resident = false;
+			page.pinned = 0;
+			pages_.push_back(std::move(page));
+		}
+
+		// Lowest y a width x height block can sit at when its left edge is at
+		// skyline segment `index`, or -1 when it does not fit.
+		static int fit(const Page& page, std::size_t index, int width, int height)
+		{
+			const auto& skyline = page.skyline;
+			int x = skyline[index].x;
+			if (x + width > static_cast<int>(page.size.x))
+			{
+				return -1;
+			}
+
+			int y = 0;
+			int left = width;
+			for (std::size_t i = index; left > 0; i++)
+			{
+				y = std::max(y, skyline[i].y);
+				left -= skyline[i].width;
+			}
+
+			return y + height <= static_cast<int>(page.size.y) ? y : -1;
+		}
+
+		static void place(Page& page, std::size_t index, int x, int y, int width, int height)
+		{
+			auto& skyline = page.skyline;
+			skyline.insert(skyline.begin() + index, { x, y + height, width });
+
+			// trim the segments the new one now covers
+			for (std::size_t i = index + 1; i < skyline.size();)
+			{
+				int overlap = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+				if (overlap <= 0)
+				{
+					break;
+				}
+
+				skyline[i].x += overlap;
+				skyline[i].width -= overlap;
+				if (skyline[i].width <= 0)
+				{
+					skyline.erase(skyline.begin() + i);
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			for (std::size_t i = 0; i + 1 < skyline.size();)
+			{
+				if (skyline[i].y == skyline[i + 1].y)
+				{
+					skyline[i].width += skyline[i + 1].width;
+					skyline.erase(skyline.begin() + i + 1);
+				}
+				else
+				{
+					i++;
+				}
+			}
+		}
+
+		// Bottom-left rule: the placement whose top ends lowest wins.
+		bool allocate(Page& page, int width, int height, sf::Vector2i& position)
+		{
+			int best_top = -1;
+			int best_width = 0;
+			std::size_t best_index = 0;
+
+			for (std::size_t i = 0; i < page.skyline.size(); i++)
+			{
+				int y = fit(page, i, width, height);
+				if (y < 0)
+				{
+					continue;
+				}
+
+				if (best_top < 0 or y + height < best_top or (y + height == best_top and page.skyline[i].width < best_width))
+				{
+					best_top = y + height;
+					best_width = page.skyline[i].width;
+					best_index = i;
+					position = { page.skyline[i].x, y };
+				}
+			}
+
+			if (best_top < 0)
+			{
+				return false;
+			}
+
+			place(page, best_index, position.x, position.y, width, height);
+			return true;
+		}
+
+		// Copies image rows [first, first + count) into the entry's cell, with
+		// the edge pixels repeated extrude_ times around the image, and
+		// uploads just those rows.
+		void blit(const Entry& entry, const sf::Uint8* source, sf::Vector2u size, unsigned int first, unsigned int count)
+		{
+			Page& page = pages_[entry.page];
+			unsigned int width = size.x + 2 * extrude_;
+
+			// the first and last rows also fill the extruded rows beside them
+			unsigned int top = first == 0 ? 0 : first + extrude_;
+			unsigned int bottom = first + count >= size.y ? size.y + 2 * extrude_ : first + count + extrude_;
+
+			std::vector<sf::Uint8> cell(static_cast<std::size_t>(width) * (bottom - top) * 4);
+
+			for (unsigned int y = top; y < bottom; y++)
+			{
+				unsigned int source_y = static_cast<unsigned int>(std::clamp(static_cast<int>(y) - extrude_, 0, static_cast<int>(size.y) - 1));
+				for (unsigned int x = 0; x < width; x++)
+				{
+					unsigned int source_x = static_cast<unsigned int>(std::clamp(static_cast<int>(x) - extrude_, 0, static_cast<int>(size.x) - 1));
+					const sf::Uint8* pixel = source + (static_cast<std::size_t>(source_y) * size.x + source_x) * 4;
+					std::copy(pixel, pixel + 4, cell.begin() + (static_cast<std::size_t>(y - top) * width + x) * 4);
+				}
+			}
+
+			unsigned int x = entry.rect.left - extrude_;
+			unsigned int y = entry.rect.top - extrude_ + top;
+			page.texture->update(cell.data(), width, bottom - top, x, y);
+		}
+
+	public:
+
+		TextureAtlas(unsigned int page_size = 1024, int padding = 1, int extrude = 1) :
+			page_size_(page_size),
+			padding_(padding),
+			extrude_(extrude)
+		{
+
+		}
+
+		// Shared atlas the built-in widgets load their images into.
+		static TextureAtlas& get()
+		{
+			static TextureAtlas atlas;
+			return atlas;
+		}
+
+		// Packs `image` under `name`. Adding a name twice returns the first
+		// region. Images added this way are pinned: their page is never
+		// evicted.
+		Region add(const std::string& name, const sf::Image& image)
+		{
+			if (Region existing = find(name))
+			{
+				return existing;
+			}
+
+			Region region = reserve(name, image.getSize());
+			if (region)
+			{
+				upload(name, image, 0, image.getSize().y);
+			}
+			return region;
+		}
+
+		// Allocates space for an image of `size` without filling it, so the
+		// pixels can be uploaded a few rows at a time with upload(). Unpinned
+		// images can be dropped with their page by evict().
+		Region reserve(const std::string& name, sf::Vector2u size, bool pinned = true)
+		{
+			if (Region existing = find(name))
+			{
+				return existing;
+			}
+
+			if (size.x == 0 or size.y == 0)
+			{
+				return Region();
+			}
+
+			int width = static_cast<int>(size.x) + 2 * extrude_ + padding_;
+			int height = static_cast<int>(size.y) + 2 * extrude_ + padding_;
+
+			sf::Vector2i position;
+			std::size_t page = 0;
+			while (page < pages_.size() and !allocate(pages_[page], width, height, position))
+			{
+				page++;
+			}
+
+			if (page == pages_.size())
+			{
+				// images bigger than a page get a page of their own
+				addPage(std::max(page_size_, static_cast<unsigned int>(width)), std::max(page_size_, static_cast<unsigned int>(height)));
+				if (!allocate(pages_.back(), width, height, position))
+				{
+					return Region();
+				}
+			}
+
+			makeResident(pages_[page]);
+			if (pinned)
+			{
+				pages_[page].pinned++;
+			}
+
+			sf::IntRect rect(position.x + extrude_, position.y + extrude_, size.x, size.y);
+			return region(entries_[name] = { page, rect, pinned });
+		}
+
+		// Fills rows [first, first + count) of a reserved region from RGBA
+		// pixels of the size the region was reserved with.
+		void upload(std::string_view name, const sf::Uint8* pixels, sf::Vector2u size, unsigned int first, unsigned int count)
+		{
+			auto it = entries_.find(std::string(name));
+			if (it != entries_.end() and count > 0)
+			{
+				blit(it->second, pixels, size, first, count);
+			}
+		}
+
+		void upload(std::string_view name, const sf::Image& image, unsigned int first, unsigned int count)
+		{
+			upload(name, image.getPixelsPtr(), image.getSize(), first, count);
+		}
+
+		// Loads and packs an image file, keyed by its path.
+		Region load(const std::string& path)
+		{
+			if (Region existing = find(path))
+			{
+				return existing;
+			}
+
+			sf::Image image;
+			if (!image.loadFromFile(path))
+			{
+				return Region();
+			}
+			return add(path, image);
+		}
+
+		Region find(std::string_view name) const
+		{
+			auto it = entries_.find(std::string(name));
+			return it != entries_.end() ? region(it->second) : Region();
+		}
+
+		std::size_t getPageCount() const
+		{
+			return pages_.size();
+		}
+
+		const sf::Texture& getPageTexture(std::size_t page) const
+		{
+			return *pages_[page].texture;
+		}
+
+		// Page a region lives on, or getPageCount() for foreign textures.
+		std::size_t getPage(const Region& region) const
+		{
+			for (std::size_t i = 0; i < pages_.size(); i++)
+			{
+				if (pages_[i].texture.get() == region.texture)
+				{
+					return i;
+				}
+			}
+			return pages_.size();
+		}
+
+		std::size_t getPageBytes(std::size_t page) const
+		{
+			return pages_[page].resident ? static_cast<std::size_t>(pages_[page].size.x) * pages_[page].size.y * 4 : 0;
+		}
+
+		std::size_t getResidentBytes() const
+		{
+			std::size_t bytes = 0;
+			for (std::size_t i = 0; i < pages_.size(); i++)
+			{
+				bytes += getPageBytes(i);
+			}
+			return bytes;
+		}
+
+		bool isEvictable(std::size_t page) const
+		{
+			return pages_[page].resident and pages_[page].pinned == 0;
+		}
+
+		// Releases an unpinned page's texture memory and forgets the images
+		// on it; the page is reused empty by later reserve() calls. Returns
+		// the bytes released.
+		std::size_t evict(std::size_t page)
+		{
+			if (!isEvictable(page))
+			{
+				return 0;
+			}
+
+			std::size_t bytes = getPageBytes(page);
+			for (auto it = entries_.begin(); it != entries_.end();)
+			{
+				it = it->second.page == page ? entries_.erase(it) : std::next(it);
+			}
+
+			Page& evicted = pages_[page];
+			*evicted.texture = sf::Texture();
+			evicted.skyline.assign(1, { 0, 0, static_cast<int>(evicted.size.x) });
+			evicted.resident = false;
+			return bytes;
+		}
+
+		// Writes `<base>_<n>.png` per page and a `<base>.atlas` index with one
+		// "page x y width height name" line per image, so the packing can be
+		// done ahead of time and loaded without repacking.
+		bool save(const std::string& base) const
+		{
+			std::ofstream index(base + ".atlas");
+			if (!index)
+			{
+				return false;
+			}
+
+			index << pages_.size() << ' ' << padding_ << ' ' << extrude_ << '\n';
+			for (std::size_t i = 0; i < pages_.size(); i++)
+			{
+				// pages only live on the GPU, so they are read back
+				sf::Image image;
+				if (pages_[i].resident)
+				{
+					image = pages_[i].texture->copyToImage();
+				}
+				else
+				{
+					image.create(pages_[i].size.x, pages_[i].size.y, sf::Color::Transparent);
+				}
+
+				if (!image.saveToFile(base + "_" + std::to_string(i) + ".png"))
+				{
+					return false;
+				}
+			}
+
+			for (const auto& [name, entry] : entries_)
+			{
+				index << entry.page << ' ' << entry.rect.left << ' ' << entry.rect.top << ' ' << entry.rect.width << ' ' << entry.rect.height << ' ' << name << '\n';
+			}
+
+			return static_cast<bool>(index);
+		}
+
+		// Replaces the atlas with one written by save(). Pages loaded this way
+		// are full, so later add() calls start new pages.
+		bool loadPacked(const std::string& base)
+		{
+			std::ifstream index(base + ".atlas");
+			std::size_t page_count;
+			if (!(index >> page_count >> padding_ >> extrude_))
+			{
+				return false;
+			}
+
+			pages_.clear();
+			entries_.clear();
+
+			for (std::size_t i = 0; i < page_count; i++)
+			{
+				Page page;
+				page.texture = std::make_unique<sf::Texture>();
+				if (!page.texture->loadFromFile(base + "_" + std::to_string(i) + ".png"))
+				{
+					return false;
+				}
+				page.size = page.texture->getSize();
+				page.skyline.push_back({ 0, static_cast<int>(page.size.y), static_cast<int>(page.size.x) });
+				page.resident = true;
+				page.pinned = 0;
+				pages_.push_back(std::move(page));
+			}
+
+			// prepacked images cannot be reloaded one by one, so they stay
+			Entry entry;
+			std::string name;
+			entry.pinned = true;
+			while (index >> entry.page >> entry.rect.left >> entry.rect.top >> entry.rect.width >> entry.rect.height)
+			{
+				index.get();
+				std::getline(index, name);
+				if (entry.page >= pages_.size())
+				{
+					return false;
+				}
+
+				pages_[entry.page].pinned++;
+				entries_[name] = entry;
+			}
+
+			return true;
+		}
+
+	};
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+namespace gui
+{
+	enum class FramePacing
+	{
+		// run as fast as the loop goes
+		None,
+		// FrameClock sleeps, then spins the last millisecond
+		Sleep,
+		// sf::Window::setFramerateLimit
+		Window,
+		// sf::Window::setVerticalSyncEnabled; the rate is the display's
+		VSync
+	};
+
+	struct FrameStats
+	{
+		float average;
+		float p50;
+		float p95;
+		float p99;
+		float max;
+	};
+
+	// Splits wall time into fixed simulation steps, so animations and timers
+	// advance the same on a 30 Hz panel as on a 144 Hz desktop. Whatever is
+	// left over becomes the interpolation factor between the last two steps.
+	class FrameClock
+	{
+	private:
+
+		static constexpr std::size_t history_size = 256;
+
+		sf::Clock clock_;
+		sf::Time frame_start_;
+
+		float step_;
+		float accumulator_;
+		float alpha_;
+		// a longer frame (a breakpoint, a dragged window) is cut to this so
+		// the steps do not pile up
+		float max_frame_;
+
+		unsigned int rate_;
+		FramePacing pacing_;
+
+		std::array<float, history_size> history_;
+		std::size_t history_count_;
+		std::size_t history_next_;
+
+		// nearest-rank index of percentile `p` among `count` sorted values
+		static std::size_t rank(float p, std::size_t count)
+		{
+			std::size_t rank = std::size_t(std::ceil(p / 100 * count));
+			return std::clamp<std::size_t>(rank, 1, count) - 1;
+		}
+
+	public:
+
+		FrameClock() :
+			step_(1.0f / 60),
+			accumulator_(0),
+			alpha_(0),
+			max_frame_(0.25f),
+			rate_(0),
+			pacing_(FramePacing::None),
+			history_count_(0),
+			history_next_(0)
+		{
+
+		}
+
+		// Wall time since the clock was created, in seconds.
+		float getTime() const
+		{
+			return clock_.getElapsedTime().asSeconds();
+		}
+
+		// Starts a frame and returns how many fixed steps it covers.
+		std::uint32_t tick()
+		{
+			sf::Time now = clock_.getElapsedTime();
+			float seconds = (now - frame_start_).asSeconds();
+			frame_start_ = now;
+
+			history_[history_next_] = seconds;
+			history_next_ = (history_next_ + 1) % history_size;
+			history_count_ = std::min(history_count_ + 1, history_size);
+
+			accumulator_ += std::min(seconds, max_frame_);
+			std::uint32_t steps = std::uint32_t(accumulator_ / step_);
+			accumulator_ -= steps * step_;
+			alpha_ = accumulator_ / step_;
+			return steps;
+		}
+
+		// Waits out the rest of the frame when the clock does the pacing;
+		// call it right after presenting.
+		void pace() const
+		{
+			if (pacing_ != FramePacing::Sleep or rate_ == 0)
+			{
+				return;
+			}
+
+			sf::Time end = frame_start_ + sf::seconds(1.0f / rate_);
+			sf::Time remaining = end - clock_.getElapsedTime();
+
+			// sleeping is only accurate to about a millisecond
+			if (remaining > sf::milliseconds(2))
+			{
+				sf::sleep(remaining - sf::milliseconds(1));
+			}
+			while (clock_.getElapsedTime() < end)
+			{
+
+			}
+		}
+
+		void setStep(float seconds)
+		{
+			step_ = std::max(seconds, 1e-4f);
+		}
+
+		float getStep() const
+		{
+			return step_;
+		}
+
+		// How far between the previous and the latest step the frame is
+		// drawn, from 0 to 1.
+		float getAlpha() const
+		{
+			return alpha_;
+		}
+
+		void setMaxFrameTime(float seconds)
+		{
+			max_frame_ = seconds;
+		}
+
+		void setPacing(unsigned int rate, FramePacing pacing)
+		{
+			rate_ = rate;
+			pacing_ = pacing;
+		}
+
+		unsigned int getRate() const
+		{
+			return rate_;
+		}
+
+		FramePacing getPacing() const
+		{
+			return pacing_;
+		}
+
+		// Percentile `p` (0..100) of the recent frame times, in seconds.
+		float getPercentile(float p) const
+		{
+			if (history_count_ == 0)
+			{
+				return 0;
+			}
+
+			std::array<float, history_size> sorted;
+			std::copy_n(history_.begin(), history_count_, sorted.begin());
+			std::size_t index = rank(p, history_count_);
+			std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + history_count_);
+			return sorted[index];
+		}
+
+		// Over the last 256 frames.
+		FrameStats getStats() const
+		{
+			if (history_count_ == 0)
+			{
+				return { 0, 0, 0, 0, 0 };
+			}
+
+			std::array<float, history_size> sorted;
+			std::copy_n(history_.begin(), history_count_, sorted.begin());
+			std::sort(sorted.begin(), sorted.begin() + history_count_);
+
+			float total = 0;
+			for (std::size_t i = 0; i < history_count_; i++)
+			{
+				total += sorted[i];
+			}
+
+			return { total / history_count_, sorted[rank(50, history_count_)], sorted[rank(95, history_count_)], sorted[rank(99, history_count_)], sorted[history_count_ - 1] };
+		}
+
+	};
+}
@@ -1,7 +1,23 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include "GUIAtlas.h"
+#include "GUIAssets.h"
+#include "GUITween.h"
+#include "GUIAnimation.h"
+#include "GUIClock.h"
+#include "GUITimer.h"
 #include <list>
+#include <vector>
+#include <algorithm>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+#include <array>
+#include <type_traits>
 
 namespace gui
 {
@@ -11,222 +27,2186 @@ namespace gui
 	{
 		Click,
 		MouseEnter,
-		MouseLeave
+		MouseLeave,
+		// from Engine::setTimeout with a listener
+		Timer,
+		FocusGained,
+		FocusLost,
+		// the text of an input changed
+		TextChanged
+	};
+
+	// What a component wants from the pointer. The engine only hit tests a
+	// component for the categories it subscribed to.
+	enum class PointerCategory : std::uint8_t
+	{
+		None = 0,
+		// press, release and click
+		Button = 1 << 0,
+		Motion = 1 << 1,
+		Drag = 1 << 2,
+		DoubleClick = 1 << 3,
+		Wheel = 1 << 4,
+		// enter() and leave() as the cursor moves over and off
+		Hover = 1 << 5
+	};
+
+	inline PointerCategory operator|(PointerCategory a, PointerCategory b)
+	{
+		return static_cast<PointerCategory>(static_cast<std::uint8_t>(a) | static_cast<std::uint8_t>(b));
+	}
+
+	inline bool operator&(PointerCategory a, PointerCategory b)
+	{
+		return (static_cast<std::uint8_t>(a) & static_cast<std::uint8_t>(b)) != 0;
+	}
+
+	enum class PointerEventType
+	{
+		Press,
+		Release,
+		// released over the component it was pressed on, without a drag
+		Click,
+		DoubleClick,
+		Move,
+		DragStart,
+		Drag,
+		DragEnd,
+		Wheel
+	};
+
+	// Subscribed ancestors of the target see an event on the way down
+	// (Capture) and again on the way back up (Bubble).
+	enum class PointerPhase
+	{
+		Capture,
+		Target,
+		Bubble
+	};
+
+	struct PointerEvent
+	{
+		PointerEventType type;
+		sf::Mouse::Button button;
+		// in the receiving component's parent space, like its position
+		sf::Vector2f position;
+		// distance from the press in the target's space for drags, wheel
+		// ticks for Wheel
+		sf::Vector2f delta;
+
+		Component* target;
+		PointerPhase phase;
+		bool stopped;
+
+		// Nobody after the current receiver sees the event.
+		void stopPropagation()
+		{
+			stopped = true;
+		}
 	};
 
 	enum class HorizontalAligment
 	{
-		Center,
-		Left,
-		Right
-	};
+		Center,
+		Left,
+		Right
+	};
+
+	enum class VerticalAligment
+	{
+		Top,
+		Bottom,
+		Center
+	};
+
+	inline const sf::Vector2f unconstrained = { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+
+	namespace utf8
+	{
+		inline constexpr sf::Uint32 replacement = 0xFFFD;
+
+		// Decodes one codepoint and advances `it`; never reads past `end`.
+		inline sf::Uint32 next(const unsigned char*& it, const unsigned char* end)
+		{
+			sf::Uint32 codepoint = *it;
+			sf::Uint32 minimum = 0;
+			int length = 1;
+
+			if (codepoint >= 0x80)
+			{
+				if ((codepoint & 0xE0) == 0xC0)
+				{
+					codepoint &= 0x1F;
+					minimum = 0x80;
+					length = 2;
+				}
+				else if ((codepoint & 0xF0) == 0xE0)
+				{
+					codepoint &= 0x0F;
+					minimum = 0x800;
+					length = 3;
+				}
+				else if ((codepoint & 0xF8) == 0xF0)
+				{
+					codepoint &= 0x07;
+					minimum = 0x10000;
+					length = 4;
+				}
+				else
+				{
+					codepoint = replacement;
+				}
+
+				if (length > 1)
+				{
+					if (end - it < length)
+					{
+						codepoint = replacement;
+						length = 1;
+					}
+					else
+					{
+						for (int i = 1; i < length; i++)
+						{
+							if ((it[i] & 0xC0) != 0x80)
+							{
+								codepoint = replacement;
+								length = 1;
+								break;
+							}
+							codepoint = (codepoint << 6) | (it[i] & 0x3F);
+						}
+
+						if (length > 1 and (codepoint < minimum or codepoint > 0x10FFFF or (codepoint >= 0xD800 and codepoint <= 0xDFFF)))
+						{
+							codepoint = replacement;
+						}
+					}
+				}
+			}
+
+			it += length;
+			return codepoint;
+		}
+
+		// Decodes UTF-8 straight into `out`, keeping its capacity, so steady-state
+		// text updates do not touch the heap. Malformed input becomes U+FFFD.
+		inline void decode(std::string_view text, sf::String& out)
+		{
+			sf::String scratch(replacement);
+			out.clear();
+
+			const unsigned char* it = reinterpret_cast<const unsigned char*>(text.data());
+			const unsigned char* end = it + text.size();
+
+			while (it != end)
+			{
+				// ASCII runs are validated a word at a time
+				while (end - it >= 8)
+				{
+					std::uint64_t word;
+					std::memcpy(&word, it, sizeof(word));
+					if (word & 0x8080808080808080ull)
+					{
+						break;
+					}
+
+					for (int i = 0; i < 8; i++)
+					{
+						scratch[0] = it[i];
+						out += scratch;
+					}
+					it += 8;
+				}
+
+				if (it == end)
+				{
+					break;
+				}
+
+				scratch[0] = next(it, end);
+				out += scratch;
+			}
+		}
+
+		inline void append(std::string& out, sf::Uint32 codepoint)
+		{
+			if (codepoint < 0x80)
+			{
+				out += static_cast<char>(codepoint);
+			}
+			else if (codepoint < 0x800)
+			{
+				out += static_cast<char>(0xC0 | (codepoint >> 6));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else if (codepoint < 0x10000)
+			{
+				out += static_cast<char>(0xE0 | (codepoint >> 12));
+				out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else
+			{
+				out += static_cast<char>(0xF0 | (codepoint >> 18));
+				out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+				out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+		}
+	}
+
+	// Formats numbers for labels without allocating; the view points into `buffer`.
+	inline std::string_view formatNumber(char (&buffer)[32], long long value)
+	{
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		return std::string_view(buffer, result.ptr - buffer);
+	}
+
+	inline std::string_view formatNumber(char (&buffer)[32], unsigned long long value)
+	{
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		return std::string_view(buffer, result.ptr - buffer);
+	}
+
+	inline std::string_view formatNumber(char (&buffer)[32], double value)
+	{
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		return std::string_view(buffer, result.ptr - buffer);
+	}
+
+	inline std::string_view formatNumber(char (&buffer)[32], double value, int precision)
+	{
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+		if (result.ec != std::errc())
+		{
+			result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision);
+		}
+		return std::string_view(buffer, result.ptr - buffer);
+	}
+
+	// A view that shows `area` of the target's current view and clips drawing
+	// to it, so a component can draw rows that overhang its own rect.
+	inline sf::View clipView(const sf::RenderTarget& target, const sf::FloatRect& area)
+	{
+		sf::Vector2f target_size(target.getSize());
+		sf::Vector2i top_left = target.mapCoordsToPixel({ area.left, area.top });
+		sf::Vector2i bottom_right = target.mapCoordsToPixel({ area.left + area.width, area.top + area.height });
+
+		sf::View view(area);
+		view.setViewport(sf::FloatRect(
+			top_left.x / target_size.x,
+			top_left.y / target_size.y,
+			(bottom_right.x - top_left.x) / target_size.x,
+			(bottom_right.y - top_left.y) / target_size.y));
+		return view;
+	}
+
+	inline sf::FloatRect viewBounds(const sf::View& view)
+	{
+		if (view.getRotation() != 0)
+		{
+			return view.getInverseTransform().transformRect(sf::FloatRect(-1, -1, 2, 2));
+		}
+		return sf::FloatRect(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+	}
+
+	// Edge-inclusive, so zero-sized components are still drawn while inside.
+	inline bool overlaps(const sf::FloatRect& a, const sf::FloatRect& b)
+	{
+		return a.left <= b.left + b.width and b.left <= a.left + a.width and a.top <= b.top + b.height and b.top <= a.top + a.height;
+	}
+
+	// Collects the glyph quads of many strings into one vertex array, drawn with
+	// a single call against the font's glyph page for the character size.
+	class GlyphBatch : public sf::Drawable
+	{
+	private:
+
+		const sf::Font* font_;
+		unsigned int character_size_;
+
+		sf::VertexArray vertices_;
+
+		static void quad(sf::VertexArray& vertices, sf::FloatRect rect, sf::FloatRect coords, sf::Color color)
+		{
+			sf::Vector2f top_left(rect.left, rect.top);
+			sf::Vector2f top_right(rect.left + rect.width, rect.top);
+			sf::Vector2f bottom_left(rect.left, rect.top + rect.height);
+			sf::Vector2f bottom_right(rect.left + rect.width, rect.top + rect.height);
+
+			sf::Vector2f uv_top_left(coords.left, coords.top);
+			sf::Vector2f uv_top_right(coords.left + coords.width, coords.top);
+			sf::Vector2f uv_bottom_left(coords.left, coords.top + coords.height);
+			sf::Vector2f uv_bottom_right(coords.left + coords.width, coords.top + coords.height);
+
+			vertices.append(sf::Vertex(top_left, color, uv_top_left));
+			vertices.append(sf::Vertex(top_right, color, uv_top_right));
+			vertices.append(sf::Vertex(bottom_left, color, uv_bottom_left));
+			vertices.append(sf::Vertex(bottom_left, color, uv_bottom_left));
+			vertices.append(sf::Vertex(top_right, color, uv_top_right));
+			vertices.append(sf::Vertex(bottom_right, color, uv_bottom_right));
+		}
+
+	public:
+
+		GlyphBatch() :
+			font_(nullptr),
+			character_size_(20),
+			vertices_(sf::Triangles)
+		{
+
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates states) const override
+		{
+			if (font_ != nullptr and vertices_.getVertexCount() > 0)
+			{
+				states.texture = &font_->getTexture(character_size_);
+				target.draw(vertices_, states);
+			}
+		}
+
+		void setFont(const sf::Font& font)
+		{
+			font_ = &font;
+		}
+
+		void setCharacterSize(unsigned int size)
+		{
+			character_size_ = size;
+		}
+
+		unsigned int getCharacterSize() const
+		{
+			return character_size_;
+		}
+
+		float getLineSpacing() const
+		{
+			return font_->getLineSpacing(character_size_);
+		}
+
+		float getAdvance(sf::Uint32 codepoint) const
+		{
+			return font_->getGlyph(codepoint, character_size_, false).advance;
+		}
+
+		const sf::Glyph& getGlyph(sf::Uint32 codepoint) const
+		{
+			return font_->getGlyph(codepoint, character_size_, false);
+		}
+
+		// Keeps the allocated capacity for the next rebuild.
+		void clear()
+		{
+			vertices_.clear();
+		}
+
+		std::size_t getVertexCount() const
+		{
+			return vertices_.getVertexCount();
+		}
+
+		// Solid rectangle, textured from the white square SFML reserves at the
+		// top-left of every glyph page.
+		void appendRect(sf::FloatRect rect, sf::Color color)
+		{
+			quad(vertices_, rect, sf::FloatRect(1, 1, 0, 0), color);
+		}
+
+		// One glyph looked up earlier with getGlyph(), for callers that keep
+		// their own table instead of going through the font per character.
+		void appendGlyph(const sf::Glyph& glyph, float x, float baseline, sf::Color color)
+		{
+			if (glyph.bounds.width > 0)
+			{
+				sf::FloatRect rect(std::floor(x) + glyph.bounds.left, baseline + glyph.bounds.top, glyph.bounds.width, glyph.bounds.height);
+				sf::FloatRect coords(glyph.textureRect.left, glyph.textureRect.top, glyph.textureRect.width, glyph.textureRect.height);
+				quad(vertices_, rect, coords, color);
+			}
+		}
+
+		// Pre-built quads, e.g. a line laid out once by layout(), moved by
+		// `offset`.
+		void append(const sf::VertexArray& vertices, sf::Vector2f offset)
+		{
+			for (std::size_t i = 0; i < vertices.getVertexCount(); i++)
+			{
+				sf::Vertex vertex = vertices[i];
+				vertex.position += offset;
+				vertices_.append(vertex);
+			}
+		}
+
+		// Lays out one line of codepoints with its top-left at the origin, for
+		// callers that keep lines and only redo the ones that change. `stops`
+		// gets the pen position before every codepoint and after the last.
+		void layout(const sf::Uint32* text, std::size_t count, sf::Color color, sf::VertexArray& vertices, std::vector<float>& stops) const
+		{
+			vertices.setPrimitiveType(sf::Triangles);
+			vertices.clear();
+			stops.resize(count + 1);
+
+			float baseline = static_cast<float>(character_size_);
+			float x = 0;
+			sf::Uint32 previous = 0;
+
+			for (std::size_t i = 0; i < count; i++)
+			{
+				sf::Uint32 codepoint = text[i];
+				x += font_->getKerning(previous, codepoint, character_size_);
+				previous = codepoint;
+				stops[i] = x;
+
+				const sf::Glyph& glyph = font_->getGlyph(codepoint == '\t' ? ' ' : codepoint, character_size_, false);
+				if (glyph.bounds.width > 0 and codepoint != '\t')
+				{
+					sf::FloatRect rect(std::floor(x) + glyph.bounds.left, baseline + glyph.bounds.top, glyph.bounds.width, glyph.bounds.height);
+					sf::FloatRect coords(glyph.textureRect.left, glyph.textureRect.top, glyph.textureRect.width, glyph.textureRect.height);
+					quad(vertices, rect, coords, color);
+				}
+				x += codepoint == '\t' ? glyph.advance * 4 : glyph.advance;
+			}
+			stops[count] = x;
+		}
+
+		// Width append() would give the line without a limit.
+		float measure(std::string_view text) const
+		{
+			const unsigned char* it = reinterpret_cast<const unsigned char*>(text.data());
+			const unsigned char* end = it + text.size();
+
+			float x = 0;
+			sf::Uint32 previous = 0;
+
+			while (it != end)
+			{
+				sf::Uint32 codepoint = *it < 0x80 ? *it++ : utf8::next(it, end);
+				if (codepoint == '\n' or codepoint == '\r')
+				{
+					break;
+				}
+
+				x += font_->getKerning(previous, codepoint, character_size_);
+				previous = codepoint;
+
+				const sf::Glyph& glyph = font_->getGlyph(codepoint == '\t' ? ' ' : codepoint, character_size_, false);
+				x += codepoint == '\t' ? glyph.advance * 4 : glyph.advance;
+			}
+
+			return x;
+		}
+
+		// Appends one line of UTF-8 text with its top-left at `position`, dropping
+		// glyphs that would cross `max_width`. Returns the pen advance.
+		float append(std::string_view text, sf::Vector2f position, sf::Color color, float max_width = unconstrained.x)
+		{
+			const unsigned char* it = reinterpret_cast<const unsigned char*>(text.data());
+			const unsigned char* end = it + text.size();
+
+			float baseline = std::floor(position.y + character_size_);
+			float x = 0;
+			sf::Uint32 previous = 0;
+
+			while (it != end)
+			{
+				sf::Uint32 codepoint = *it < 0x80 ? *it++ : utf8::next(it, end);
+				if (codepoint == '\n' or codepoint == '\r')
+				{
+					break;
+				}
+
+				x += font_->getKerning(previous, codepoint, character_size_);
+				previous = codepoint;
+
+				const sf::Glyph& glyph = font_->getGlyph(codepoint == '\t' ? ' ' : codepoint, character_size_, false);
+				float advance = codepoint == '\t' ? glyph.advance * 4 : glyph.advance;
+
+				if (x + advance > max_width)
+				{
+					break;
+				}
+
+				if (glyph.bounds.width > 0 and codepoint != '\t')
+				{
+					sf::FloatRect rect(std::floor(position.x + x) + glyph.bounds.left, baseline + glyph.bounds.top, glyph.bounds.width, glyph.bounds.height);
+					sf::FloatRect coords(glyph.textureRect.left, glyph.textureRect.top, glyph.textureRect.width, glyph.textureRect.height);
+					quad(vertices_, rect, coords, color);
+				}
+
+				x += advance;
+			}
+
+			return x;
+		}
+
+	};
+
+	class IEventListener
+	{
+	protected:
+
+		IEventListener()
+		{
+			
+		}
+
+	public:
+
+		virtual void handleGUIEvent(EventType type, const Component* component) = 0;
+
+	};
+
+	class Engine
+	{
+	private:
+
+		struct CursorMapping
+		{
+			sf::Vector2f center;
+			sf::Vector2f size;
+			float rotation;
+			sf::FloatRect viewport;
+			sf::Vector2i pixel;
+			sf::Vector2f position;
+		};
+
+		sf::RenderWindow* window_;
+
+		std::vector<Component*> anchored_;
+		bool pixel_view_;
+
+		FrameClock clock_;
+		TimerWheel timers_;
+
+		// Pointer state. A press captures the component under it: moves and
+		// the release go there even when the cursor has left it.
+		std::vector<Component*> pointer_targets_;
+		Component* captured_;
+		sf::Mouse::Button captured_button_;
+		sf::Vector2f press_point_;
+		sf::Vector2i press_pixel_;
+		bool dragging_;
+		int drag_threshold_;
+
+		const Component* last_click_;
+		sf::Vector2i last_click_pixel_;
+		float last_click_time_;
+		float double_click_time_;
+
+		// components drawn before this stamp were not drawn last frame
+		std::uint32_t draw_mark_;
+
+		// Root-to-target chain of the last hit, reused by every event of a
+		// gesture until the target or the tree changes.
+		std::vector<Component*> path_;
+		std::vector<sf::Vector2f> path_points_;
+		const Component* path_target_;
+		std::uint32_t path_version_;
+
+		// the top one takes all pointer input
+		std::vector<Component*> modals_;
+
+		// topmost Hover subscriber under the cursor, found on every move
+		Component* hovered_;
+
+		// Focusable components in Tab order, linked through the components
+		// themselves, so moving on is O(1) and so is joining or leaving.
+		Component* focus_head_;
+		Component* focus_tail_;
+		Component* focused_;
+
+		bool canFocus(const Component* component) const;
+		void handleKey(const sf::Event::KeyEvent& key);
+
+		Component* pick(sf::Vector2f point, PointerCategory categories) const;
+		const std::vector<Component*>& route(Component* target);
+		bool dispatch(Component* target, PointerEventType type, sf::Mouse::Button button, sf::Vector2f point, sf::Vector2f delta = { 0, 0 });
+		void cancelCapture();
+		void setHovered(Component* component);
+		void handlePointer(const sf::Event& event);
+
+		// The cursor is sampled from events once instead of being queried by
+		// every component, and its mapping is cached per view (UI layer,
+		// world layer, ...) until the view or the cursor changes.
+		sf::Vector2i cursor_pixel_;
+		mutable std::array<CursorMapping, 4> cursor_cache_;
+		mutable std::size_t cursor_cache_size_;
+		mutable std::size_t cursor_cache_next_;
+
+		static std::vector<Engine*>& engines()
+		{
+			static std::vector<Engine*> engines;
+			return engines;
+		}
+
+	public:
+
+		Engine(sf::RenderWindow* window) :
+			window_(window),
+			pixel_view_(false),
+			captured_(nullptr),
+			captured_button_(sf::Mouse::Left),
+			dragging_(false),
+			drag_threshold_(4),
+			last_click_(nullptr),
+			last_click_time_(0),
+			double_click_time_(0.4f),
+			draw_mark_(0),
+			path_target_(nullptr),
+			path_version_(0),
+			hovered_(nullptr),
+			focus_head_(nullptr),
+			focus_tail_(nullptr),
+			focused_(nullptr),
+			cursor_pixel_(sf::Mouse::getPosition(*window)),
+			cursor_cache_size_(0),
+			cursor_cache_next_(0)
+		{
+			engines().push_back(this);
+		}
+
+		~Engine();
+
+		Engine(const Engine&) = delete;
+		Engine& operator=(const Engine&) = delete;
+
+		static Engine* find(const sf::RenderWindow* window)
+		{
+			for (auto engine : engines())
+			{
+				if (engine->window_ == window)
+				{
+					return engine;
+				}
+			}
+			return nullptr;
+		}
+
+		void handleEvent(const sf::Event& event);
+
+		// Work that is not tied to an event; call once per frame before drawing.
+		void update();
+
+		// Presents the frame, then waits out the rest of it if the engine
+		// does the pacing. Use instead of window.display().
+		void display()
+		{
+			window_->display();
+			clock_.pace();
+		}
+
+		// Targets `rate` frames per second; 0 removes the limit. With VSync
+		// the display sets the rate and `rate` is only a hint.
+		void setFrameRate(unsigned int rate, FramePacing pacing = FramePacing::Sleep)
+		{
+			clock_.setPacing(rate, pacing);
+			window_->setVerticalSyncEnabled(pacing == FramePacing::VSync);
+			window_->setFramerateLimit(pacing == FramePacing::Window ? rate : 0);
+		}
+
+		// Length of one animation and timer step; 1/60 s by default.
+		void setTimeStep(float seconds)
+		{
+			clock_.setStep(seconds);
+		}
+
+		float getInterpolation() const
+		{
+			return clock_.getAlpha();
+		}
+
+		FrameStats getFrameStats() const
+		{
+			return clock_.getStats();
+		}
+
+		const FrameClock& getClock() const
+		{
+			return clock_;
+		}
+
+		static std::uint32_t toMilliseconds(float seconds)
+		{
+			return std::uint32_t(std::max(seconds, 0.0f) * 1000 + 0.5f);
+		}
+
+		// Timers run from update() on the UI thread, on the fixed time step,
+		// so they can touch widgets directly.
+		TimerId setTimeout(float seconds, std::function<void()> callback)
+		{
+			return timers_.add(toMilliseconds(seconds), std::move(callback));
+		}
+
+		TimerId setInterval(float seconds, std::function<void()> callback)
+		{
+			return timers_.add(toMilliseconds(seconds), std::move(callback), std::max<std::uint32_t>(toMilliseconds(seconds), 1));
+		}
+
+		// Sends EventType::Timer about `component` to `listener`, e.g. to
+		// show a tooltip from a MouseEnter handler. Cancel it before the
+		// listener goes away.
+		TimerId setTimeout(float seconds, IEventListener* listener, const Component* component)
+		{
+			return setTimeout(seconds, [listener, component]()
+			{
+				listener->handleGUIEvent(EventType::Timer, component);
+			});
+		}
+
+		// Moves the deadline to `seconds` from now, for debouncing.
+		bool restartTimer(TimerId id, float seconds)
+		{
+			return timers_.restart(id, toMilliseconds(seconds));
+		}
+
+		bool cancelTimer(TimerId id)
+		{
+			return timers_.cancel(id);
+		}
+
+		bool isTimerActive(TimerId id) const
+		{
+			return timers_.isActive(id);
+		}
+
+		// Pixels the pointer has to travel from a press before it drags.
+		void setDragThreshold(int pixels)
+		{
+			drag_threshold_ = pixels;
+		}
+
+		void setDoubleClickTime(float seconds)
+		{
+			double_click_time_ = seconds;
+		}
+
+		const Component* getCaptured() const
+		{
+			return captured_;
+		}
+
+		// Makes `overlay` the only thing the pointer reaches: hit testing
+		// starts at it and never looks at what is beneath. Overlays stack.
+		void pushModal(Component* overlay);
+		void popModal();
+		void removeModal(Component* overlay);
+
+		Component* getModal() const
+		{
+			return modals_.empty() ? nullptr : modals_.back();
+		}
+
+		// Whether a modal overlay keeps the pointer away from `component`.
+		bool isBlocked(const Component* component) const;
+
+		// Gives `component` keyboard focus; nullptr clears it.
+		void setFocus(Component* component);
+
+		Component* getFocused() const
+		{
+			return focused_;
+		}
+
+		// Tab and Shift-Tab.
+		bool focusNext();
+		bool focusPrevious();
+
+		// Arrow keys: the nearest focusable component on screen in
+		// `direction`, weighing distance off the axis twice.
+		bool focusDirection(sf::Vector2f direction);
+
+		// Moves `component` in the Tab order to right after `after`, or to
+		// the front when `after` is nullptr.
+		void setFocusOrder(Component* component, Component* after);
+
+		void setFocusRing(sf::Color color, float thickness);
+
+		void addFocusable(Component* component);
+		void removeFocusable(Component* component);
+
+		sf::Vector2i getCursorPixel() const
+		{
+			return cursor_pixel_;
+		}
+
+		sf::Vector2f mapCursor(const sf::View& view) const
+		{
+			const sf::Vector2f& center = view.getCenter();
+			const sf::Vector2f& size = view.getSize();
+			const sf::FloatRect& viewport = view.getViewport();
+
+			for (std::size_t i = 0; i < cursor_cache_size_; i++)
+			{
+				const CursorMapping& mapping = cursor_cache_[i];
+				if (mapping.pixel == cursor_pixel_ and mapping.center == center and mapping.size == size and mapping.rotation == view.getRotation() and mapping.viewport == viewport)
+				{
+					return mapping.position;
+				}
+			}
+
+			sf::Vector2f position = window_->mapPixelToCoords(cursor_pixel_, view);
+
+			cursor_cache_[cursor_cache_next_] = { center, size, view.getRotation(), viewport, cursor_pixel_, position };
+			cursor_cache_next_ = (cursor_cache_next_ + 1) % cursor_cache_.size();
+			cursor_cache_size_ = std::min(cursor_cache_size_ + 1, cursor_cache_.size());
+
+			return position;
+		}
+
+		// With this on, a resize resets the window's view to one unit per
+		// pixel instead of leaving the view the application set. Anchors
+		// follow whichever view is current.
+		void setPixelView(bool pixel_view)
+		{
+			pixel_view_ = pixel_view;
+		}
+
+		void addAnchored(Component* component);
+		void removeAnchored(Component* component);
+
+		void addPointerTarget(Component* component);
+		void removePointerTarget(Component* component);
+
+	};
+
+	class Component : public sf::Drawable, public ITweenTarget
+	{
+		friend class Container;
+		friend class Engine;
+
+		struct Anchor
+		{
+			bool horizontal;
+			bool vertical;
+			HorizontalAligment horizontal_aligment;
+			VerticalAligment vertical_aligment;
+		};
+
+		Anchor anchor_;
+		Engine* anchor_engine_;
+		std::size_t anchor_index_;
+
+		PointerCategory pointer_categories_;
+		Engine* pointer_engine_;
+		std::size_t pointer_index_;
+
+		// order in which components were last drawn, for picking the topmost
+		mutable std::uint32_t draw_stamp_;
+		static inline std::uint32_t draw_counter_ = 0;
+
+		bool modal_;
+
+		// bumped whenever a component changes parent, to drop cached paths
+		static inline std::uint32_t tree_version_ = 0;
+
+		bool focusable_;
+		bool has_focus_;
+		Engine* focus_engine_;
+		Component* focus_prev_;
+		Component* focus_next_;
+
+		static inline sf::Color focus_ring_color_ = sf::Color(80, 160, 255);
+		static inline float focus_ring_thickness_ = 2;
+
+	public:
+
+		bool visibility;
+		bool activity;
+
+	protected:
+
+		std::list<IEventListener*> listeners_;
+
+		mutable EventType event_;
+
+		sf::RenderWindow* window_;
+		Component* parent_;
+
+		sf::Vector2f position_;
+		sf::Vector2f size_;
+
+		bool layout_dirty_;
+	
+		Component(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			anchor_({ false, false, HorizontalAligment::Left, VerticalAligment::Top }),
+			anchor_engine_(nullptr),
+			anchor_index_(0),
+			pointer_categories_(PointerCategory::None),
+			pointer_engine_(nullptr),
+			pointer_index_(0),
+			draw_stamp_(0),
+			modal_(false),
+			focusable_(false),
+			has_focus_(false),
+			focus_engine_(nullptr),
+			focus_prev_(nullptr),
+			focus_next_(nullptr),
+			position_(position),
+			size_(size),
+			window_(window),
+			parent_(nullptr),
+			visibility(true),
+			activity(true),
+			event_(EventType::MouseLeave),
+			layout_dirty_(true)
+		{
+
+		}
+
+		Component(sf::RenderWindow* window) :
+			anchor_({ false, false, HorizontalAligment::Left, VerticalAligment::Top }),
+			anchor_engine_(nullptr),
+			anchor_index_(0),
+			pointer_categories_(PointerCategory::None),
+			pointer_engine_(nullptr),
+			pointer_index_(0),
+			draw_stamp_(0),
+			modal_(false),
+			focusable_(false),
+			has_focus_(false),
+			focus_engine_(nullptr),
+			focus_prev_(nullptr),
+			focus_next_(nullptr),
+			position_({ 0, 0 }),
+			size_({ 0, 0 }),
+			window_(window),
+			parent_(nullptr),
+			visibility(true),
+			activity(true),
+			event_(EventType::MouseLeave),
+			layout_dirty_(true)
+		{
+
+		}
+
+		// Marks the desired size as stale. Propagation stops at components that
+		// are already dirty, so a burst of updates costs one walk up the tree.
+		void invalidateLayout()
+		{
+			if (layout_dirty_)
+			{
+				return;
+			}
+
+			layout_dirty_ = true;
+			if (parent_ != nullptr)
+			{
+				parent_->childLayoutChanged();
+			}
+		}
+
+		virtual void childLayoutChanged()
+		{
+
+		}
+
+		// Tells the ancestors that this component's pixels changed, so cached
+		// renderings of it (see ScrollView) get refreshed.
+		void requestRedraw() const
+		{
+			if (parent_ != nullptr)
+			{
+				parent_->childRedrawRequested(getBounds());
+			}
+		}
+
+		// `area` is in this component's child space.
+		virtual void childRedrawRequested(const sf::FloatRect& area)
+		{
+			if (parent_ != nullptr)
+			{
+				parent_->childRedrawRequested(area);
+			}
+		}
+
+		// Checked first thing in draw(): a component outside the target's view
+		// skips hit testing, geometry updates and the draw call.
+		bool isCulled(const sf::RenderTarget& target, const sf::RenderStates& states) const
+		{
+			return !overlaps(viewBounds(target.getView()), states.transform.transformRect(getBounds()));
+		}
+
+		void attachAnchor();
+		void detachAnchor();
+
+		void attachPointer();
+		void detachPointer();
+
+		// Wheel scrolling distance per tick.
+		static inline constexpr float wheel_step = 40;
+
+		// Called from draw() (or the hit test pass standing in for it).
+		void markDrawn() const
+		{
+			draw_stamp_ = ++draw_counter_;
+			if (pointer_engine_ == nullptr and pointer_categories_ != PointerCategory::None)
+			{
+				// subscribed before the engine existed
+				const_cast<Component*>(this)->attachPointer();
+			}
+			if (focus_engine_ == nullptr and focusable_)
+			{
+				const_cast<Component*>(this)->attachFocus();
+			}
+			if (anchor_engine_ == nullptr and (anchor_.horizontal or anchor_.vertical))
+			{
+				const_cast<Component*>(this)->attachAnchor();
+			}
+		}
+
+		void attachFocus();
+		void detachFocus();
+
+		// Inverse of toChildSpace.
+		virtual void fromChildSpace(sf::Vector2f&) const
+		{
+
+		}
+
+		// Maps a point in this component's parent space to window view
+		// coordinates.
+		sf::Vector2f mapToRoot(sf::Vector2f point) const
+		{
+			for (const Component* parent = parent_; parent != nullptr; parent = parent->parent_)
+			{
+				parent->fromChildSpace(point);
+			}
+			return point;
+		}
+
+		// Key presses while focused; ancestors get the ones the focused
+		// component leaves. Returns whether the key was used.
+		virtual bool keyEvent(const sf::Event::KeyEvent&)
+		{
+			return false;
+		}
+
+		// Characters typed while focused, from sf::Event::TextEntered.
+		virtual bool textEvent(sf::Uint32)
+		{
+			return false;
+		}
+
+		virtual void focusChanged(bool focused)
+		{
+			requestRedraw();
+			notifyListeners(focused ? EventType::FocusGained : EventType::FocusLost);
+		}
+
+		// Outline inside the bounds while the component has keyboard focus.
+		void drawFocus(sf::RenderTarget& target, const sf::RenderStates& states) const
+		{
+			if (has_focus_)
+			{
+				sf::RectangleShape ring(size_);
+				ring.setPosition(position_);
+				ring.setFillColor(sf::Color::Transparent);
+				ring.setOutlineColor(focus_ring_color_);
+				ring.setOutlineThickness(-focus_ring_thickness_);
+				target.draw(ring, states);
+			}
+		}
+
+		// Maps a point from this component's parent space into the space of
+		// its children. Returns false where the children are clipped away.
+		virtual bool toChildSpace(sf::Vector2f&) const
+		{
+			return true;
+		}
+
+		// Maps a point in window view coordinates into this component's
+		// parent space; false if an ancestor clips it.
+		bool mapFromRoot(sf::Vector2f& point) const
+		{
+			if (parent_ == nullptr)
+			{
+				return true;
+			}
+			bool visible = parent_->mapFromRoot(point);
+			return parent_->toChildSpace(point) and visible;
+		}
+
+		// The topmost component of this subtree under `point` (in this
+		// component's parent space) that subscribed to one of `categories`.
+		virtual Component* hitTest(sf::Vector2f point, PointerCategory categories)
+		{
+			if (visibility and activity and pointer_categories_ & categories and sf::FloatRect(position_, size_).contains(point))
+			{
+				return this;
+			}
+			return nullptr;
+		}
+
+		// Pointer events for the categories passed to subscribe(), as the
+		// target or as a subscribed ancestor of it; see PointerPhase.
+		virtual void pointerEvent(PointerEvent&)
+		{
+
+		}
+
+		void applyAligment()
+		{
+			sf::Vector2f size = measure(unconstrained);
+			sf::Vector2f position = position_;
+			sf::FloatRect view = viewBounds(window_->getView());
+
+			if (anchor_.vertical)
+			{
+				switch (anchor_.vertical_aligment)
+				{
+				case VerticalAligment::Top:
+					position.y = view.top;
+					break;
+
+				case VerticalAligment::Bottom:
+					position.y = view.top + view.height - size.y;
+					break;
+
+				case VerticalAligment::Center:
+					position.y = view.top + view.height / 2 - size.y / 2;
+					break;
+				}
+			}
+
+			if (anchor_.horizontal)
+			{
+				switch (anchor_.horizontal_aligment)
+				{
+				case HorizontalAligment::Center:
+					position.x = view.left + view.width / 2 - size.x / 2;
+					break;
+
+				case HorizontalAligment::Left:
+					position.x = view.left;
+					break;
+
+				case HorizontalAligment::Right:
+					position.x = view.left + view.width - size.x;
+					break;
+				}
+			}
+
+			setPosition(position);
+		}
+
+		void notifyListeners() const
+		{
+			notifyListeners(event_);
+		}
+
+		void notifyListeners(EventType type) const
+		{
+			for (auto listener : listeners_)
+			{
+				listener->handleGUIEvent(type, this);
+			}
+		}
+
+		virtual void click() const
+		{
+			if (event_ != EventType::Click)
+			{
+				event_ = EventType::Click;
+				requestRedraw();
+				notifyListeners();
+				std::cout << "click!\n";
+			}
+		}
+
+		virtual void enter() const
+		{
+			if (event_ != EventType::MouseEnter)
+			{
+				event_ = EventType::MouseEnter;
+				requestRedraw();
+				notifyListeners();
+				std::cout << "enter!\n";
+			}
+		}
+
+		virtual void leave() const
+		{
+			if (event_ != EventType::MouseLeave)
+			{
+				event_ = EventType::MouseLeave;
+				requestRedraw();
+				notifyListeners();
+				std::cout << "leave!\n";
+			}
+		}
+
+		// Makes the component pickable for the next events. Hover comes from
+		// Engine as enter() and leave() for Hover subscribers only.
+		virtual void update() const
+		{
+			markDrawn();
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override = 0;
+
+	public:
+
+		~Component() override
+		{
+			detachAnchor();
+			detachPointer();
+			detachFocus();
+
+			if (modal_)
+			{
+				if (Engine* engine = Engine::find(window_))
+				{
+					engine->removeModal(this);
+				}
+			}
+		}
+
+		// Starts delivering pointer events of `categories` to pointerEvent().
+		void subscribe(PointerCategory categories)
+		{
+			pointer_categories_ = pointer_categories_ | categories;
+			attachPointer();
+		}
+
+		void unsubscribe()
+		{
+			pointer_categories_ = PointerCategory::None;
+			detachPointer();
+			// the engine no longer sends the leave()
+			leave();
+		}
+
+		PointerCategory getSubscription() const
+		{
+			return pointer_categories_;
+		}
+
+		// Joins the Tab order at its end.
+		void setFocusable(bool focusable)
+		{
+			focusable_ = focusable;
+			if (focusable_)
+			{
+				attachFocus();
+			}
+			else
+			{
+				detachFocus();
+			}
+		}
+
+		bool isFocusable() const
+		{
+			return focusable_;
+		}
+
+		bool hasFocus() const
+		{
+			return has_focus_;
+		}
+
+		// Staying put redraws nothing, so re-arranging a layout that did not
+		// change keeps caches of it valid.
+		virtual void setPosition(const sf::Vector2f position)
+		{
+			if (position == position_)
+			{
+				return;
+			}
+
+			requestRedraw();
+			position_ = position;
+			requestRedraw();
+		}
+
+		void addListener(IEventListener* listener)
+		{
+			listeners_.push_back(listener);
+		}
+
+		void remoteListener(IEventListener* listener)
+		{
+			listeners_.remove(listener);
+		}
+
+		sf::Vector2f getPosition() const
+		{
+			return position_;
+		}
+
+		sf::Vector2f getSize() const
+		{
+			return size_;
+		}
+
+		Component* getParent() const
+		{
+			return parent_;
+		}
+
+		// The engine of the component's window, for timers and the like.
+		Engine* getEngine() const
+		{
+			return Engine::find(window_);
+		}
+
+		// Moves smoothly instead of jumping; see TweenSystem.
+		TweenHandle animatePosition(sf::Vector2f position, float duration, Easing easing = Easing::QuadOut)
+		{
+			return TweenSystem::get().animate(this, TweenChannel::Position, { position.x, position.y }, duration, easing);
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			if (channel == TweenChannel::Position)
+			{
+				value[0] = position_.x;
+				value[1] = position_.y;
+				return 2;
+			}
+			return 0;
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			if (channel == TweenChannel::Position)
+			{
+				setPosition({ value[0], value[1] });
+			}
+		}
+
+		// Rect in the parent's child space.
+		virtual sf::FloatRect getBounds() const
+		{
+			return sf::FloatRect(position_, size_);
+		}
+
+		// Maps this component's child space to window space. Only containers
+		// have children, so everything else reports identity.
+		virtual const sf::Transform& getWorldTransform() const
+		{
+			return sf::Transform::Identity;
+		}
+
+		virtual const sf::Transform& getInverseWorldTransform() const
+		{
+			return sf::Transform::Identity;
+		}
+
+		virtual void invalidateWorldTransform()
+		{
+
+		}
+
+		// Desired size for the given available space. Leaves size themselves.
+		virtual sf::Vector2f measure(sf::Vector2f)
+		{
+			layout_dirty_ = false;
+			return size_;
+		}
+
+		// Final placement from a parent layout. Leaves that cannot stretch ignore the size.
+		virtual void arrange(sf::Vector2f position, sf::Vector2f)
+		{
+			setPosition(position);
+		}
+
+		void setAligment(VerticalAligment aligment)
+		{
+			anchor_.vertical = true;
+			anchor_.vertical_aligment = aligment;
+			attachAnchor();
+			applyAligment();
+		}
+
+		void setAligment(HorizontalAligment aligment)
+		{
+			anchor_.horizontal = true;
+			anchor_.horizontal_aligment = aligment;
+			attachAnchor();
+			applyAligment();
+		}
+
+		// Stops following the window edges; the component stays where it is.
+		void clearAligment()
+		{
+			anchor_.horizontal = false;
+			anchor_.vertical = false;
+			detachAnchor();
+		}
+
+	};
+
+	inline Engine::~Engine()
+	{
+		for (auto component : anchored_)
+		{
+			component->anchor_engine_ = nullptr;
+		}
+		for (auto component : pointer_targets_)
+		{
+			component->pointer_engine_ = nullptr;
+		}
+		for (Component* component = focus_head_; component != nullptr; component = component->focus_next_)
+		{
+			component->focus_engine_ = nullptr;
+			component->has_focus_ = false;
+		}
+
+		auto& list = engines();
+		list.erase(std::find(list.begin(), list.end(), this));
+	}
+
+	inline void Engine::handleEvent(const sf::Event& event)
+	{
+		if (event.type == sf::Event::MouseMoved)
+		{
+			cursor_pixel_ = { event.mouseMove.x, event.mouseMove.y };
+		}
+		else if (event.type == sf::Event::MouseButtonPressed or event.type == sf::Event::MouseButtonReleased)
+		{
+			cursor_pixel_ = { event.mouseButton.x, event.mouseButton.y };
+		}
+		else if (event.type == sf::Event::MouseLeft)
+		{
+			// far enough away that nothing on screen is under it
+			cursor_pixel_ = { -1000000, -1000000 };
+		}
+		else if (event.type == sf::Event::Resized)
+		{
+			if (pixel_view_)
+			{
+				window_->setView(sf::View(sf::FloatRect(0, 0, event.size.width, event.size.height)));
+			}
+
+			for (auto component : anchored_)
+			{
+				component->applyAligment();
+			}
+		}
+
+		handlePointer(event);
+	}
+
+	// The topmost component under `point` that subscribed to one of
+	// `categories`. Only subscribed components are looked at, and only those
+	// drawn in the last frame.
+	inline Component* Engine::pick(sf::Vector2f point, PointerCategory categories) const
+	{
+		if (!modals_.empty())
+		{
+			// only the overlay's own subtree is walked
+			Component* modal = modals_.back();
+			return modal->mapFromRoot(point) ? modal->hitTest(point, categories) : nullptr;
+		}
+
+		Component* best = nullptr;
+		for (auto component : pointer_targets_)
+		{
+			if (!(component->pointer_categories_ & categories) or component->draw_stamp_ <= draw_mark_ or !component->visibility or !component->activity)
+			{
+				continue;
+			}
+			if (best != nullptr and component->draw_stamp_ < best->draw_stamp_)
+			{
+				continue;
+			}
+
+			sf::Vector2f local = point;
+			if (component->mapFromRoot(local) and sf::FloatRect(component->position_, component->size_).contains(local))
+			{
+				best = component;
+			}
+		}
+		return best;
+	}
+
+	inline const std::vector<Component*>& Engine::route(Component* target)
+	{
+		if (target != path_target_ or path_version_ != Component::tree_version_)
+		{
+			path_.clear();
+			for (Component* component = target; component != nullptr; component = component->parent_)
+			{
+				path_.push_back(component);
+			}
+			std::reverse(path_.begin(), path_.end());
+
+			path_target_ = target;
+			path_version_ = Component::tree_version_;
+		}
+		return path_;
+	}
+
+	// Capture from the root down to the target's parent, the target, then
+	// bubble back up. Only components subscribed to the event's category
+	// are called. Returns whether the event reached the target.
+	inline bool Engine::dispatch(Component* target, PointerEventType type, sf::Mouse::Button button, sf::Vector2f point, sf::Vector2f delta)
+	{
+		PointerCategory category;
+		switch (type)
+		{
+		case PointerEventType::Move:
+			category = PointerCategory::Motion;
+			break;
+
+		case PointerEventType::DragStart:
+		case PointerEventType::Drag:
+		case PointerEventType::DragEnd:
+			category = PointerCategory::Drag;
+			break;
+
+		case PointerEventType::DoubleClick:
+			category = PointerCategory::DoubleClick;
+			break;
+
+		case PointerEventType::Wheel:
+			category = PointerCategory::Wheel;
+			break;
+
+		default:
+			category = PointerCategory::Button;
+			break;
+		}
+
+		const std::vector<Component*>& path = route(target);
+		std::size_t last = path.size() - 1;
+
+		// one walk down the chain maps the point for every receiver
+		path_points_.resize(path.size());
+		for (std::size_t i = 0; i < path.size(); i++)
+		{
+			path_points_[i] = point;
+			path[i]->toChildSpace(point);
+		}
+
+		PointerEvent event = { type, button, { 0, 0 }, delta, target, PointerPhase::Capture, false };
+		for (std::size_t i = 0; i < last; i++)
+		{
+			if (path[i]->pointer_categories_ & category)
+			{
+				event.position = path_points_[i];
+				path[i]->pointerEvent(event);
+				if (event.stopped)
+				{
+					return false;
+				}
+			}
+		}
+
+		event.phase = PointerPhase::Target;
+		event.position = path_points_[last];
+		target->pointerEvent(event);
+
+		event.phase = PointerPhase::Bubble;
+		for (std::size_t i = last; i-- > 0 and !event.stopped;)
+		{
+			if (path[i]->pointer_categories_ & category)
+			{
+				event.position = path_points_[i];
+				path[i]->pointerEvent(event);
+			}
+		}
+		return true;
+	}
+
+	inline void Engine::cancelCapture()
+	{
+		if (captured_ != nullptr)
+		{
+			Component* target = captured_;
+			captured_ = nullptr;
+			if (dragging_)
+			{
+				dragging_ = false;
+				dispatch(target, PointerEventType::DragEnd, captured_button_, press_point_);
+			}
+		}
+	}
+
+	inline void Engine::setHovered(Component* component)
+	{
+		if (component == hovered_)
+		{
+			return;
+		}
+
+		Component* previous = hovered_;
+		hovered_ = component;
+		if (previous != nullptr)
+		{
+			previous->leave();
+		}
+		if (component != nullptr)
+		{
+			component->enter();
+		}
+	}
+
+	inline void Engine::pushModal(Component* overlay)
+	{
+		cancelCapture();
+		overlay->modal_ = true;
+		modals_.push_back(overlay);
+
+		if (hovered_ != nullptr and isBlocked(hovered_))
+		{
+			setHovered(nullptr);
+		}
+
+		if (focused_ != nullptr and isBlocked(focused_))
+		{
+			setFocus(nullptr);
+		}
+	}
+
+	inline void Engine::popModal()
+	{
+		if (!modals_.empty())
+		{
+			Component* overlay = modals_.back();
+			modals_.pop_back();
+			overlay->modal_ = std::find(modals_.begin(), modals_.end(), overlay) != modals_.end();
+		}
+	}
+
+	inline void Engine::removeModal(Component* overlay)
+	{
+		modals_.erase(std::remove(modals_.begin(), modals_.end(), overlay), modals_.end());
+		overlay->modal_ = false;
+	}
+
+	// Focusable, shown in the last frame and not under a modal overlay.
+	inline bool Engine::canFocus(const Component* component) const
+	{
+		return component->visibility and component->activity and component->draw_stamp_ > draw_mark_ and !isBlocked(component);
+	}
 
-	enum class VerticalAligment
+	inline void Engine::setFocus(Component* component)
 	{
-		Top,
-		Bottom,
-		Center
-	};
+		if (component == focused_)
+		{
+			return;
+		}
 
-	class IEventListener
+		Component* previous = focused_;
+		focused_ = component;
+		if (previous != nullptr)
+		{
+			previous->has_focus_ = false;
+			previous->focusChanged(false);
+		}
+		if (component != nullptr)
+		{
+			component->has_focus_ = true;
+			component->focusChanged(true);
+		}
+	}
+
+	inline bool Engine::focusNext()
 	{
-	protected:
+		Component* start = focused_ != nullptr ? focused_ : focus_tail_;
+		if (start == nullptr)
+		{
+			return false;
+		}
 
-		IEventListener()
+		// wraps around; usually the very next one qualifies
+		Component* component = start;
+		do
 		{
-			
+			component = component->focus_next_ != nullptr ? component->focus_next_ : focus_head_;
+			if (canFocus(component))
+			{
+				setFocus(component);
+				return true;
+			}
+		} while (component != start);
+		return false;
+	}
+
+	inline bool Engine::focusPrevious()
+	{
+		Component* start = focused_ != nullptr ? focused_ : focus_head_;
+		if (start == nullptr)
+		{
+			return false;
 		}
 
-	public:
+		Component* component = start;
+		do
+		{
+			component = component->focus_prev_ != nullptr ? component->focus_prev_ : focus_tail_;
+			if (canFocus(component))
+			{
+				setFocus(component);
+				return true;
+			}
+		} while (component != start);
+		return false;
+	}
 
-		virtual void handleGUIEvent(EventType type, const Component* component) = 0;
+	inline bool Engine::focusDirection(sf::Vector2f direction)
+	{
+		if (focused_ == nullptr)
+		{
+			return focusNext();
+		}
 
-	};
+		sf::Vector2f from = focused_->mapToRoot(focused_->position_ + focused_->size_ / 2.0f);
+
+		Component* best = nullptr;
+		float best_score = std::numeric_limits<float>::max();
+		for (Component* component = focus_head_; component != nullptr; component = component->focus_next_)
+		{
+			if (component == focused_ or !canFocus(component))
+			{
+				continue;
+			}
+
+			sf::Vector2f to = component->mapToRoot(component->position_ + component->size_ / 2.0f) - from;
+			float along = to.x * direction.x + to.y * direction.y;
+			if (along <= 0)
+			{
+				continue;
+			}
+
+			float across = std::abs(to.x * direction.y - to.y * direction.x);
+			float score = along + 2 * across;
+			if (score < best_score)
+			{
+				best_score = score;
+				best = component;
+			}
+		}
+
+		if (best != nullptr)
+		{
+			setFocus(best);
+			return true;
+		}
+		return false;
+	}
 
-	class Component : public sf::Drawable
+	inline void Engine::handleKey(const sf::Event::KeyEvent& key)
 	{
-	public:
+		for (Component* component = focused_; component != nullptr; component = component->parent_)
+		{
+			if (component->keyEvent(key))
+			{
+				return;
+			}
+		}
 
-		bool visibility;
-		bool activity;
+		switch (key.code)
+		{
+		case sf::Keyboard::Tab:
+			key.shift ? focusPrevious() : focusNext();
+			break;
 
-	protected:
+		case sf::Keyboard::Left:
+			focusDirection({ -1, 0 });
+			break;
 
-		std::list<IEventListener*> listeners_;
+		case sf::Keyboard::Right:
+			focusDirection({ 1, 0 });
+			break;
 
-		mutable EventType event_;
+		case sf::Keyboard::Up:
+			focusDirection({ 0, -1 });
+			break;
 
-		sf::RenderWindow* window_;
+		case sf::Keyboard::Down:
+			focusDirection({ 0, 1 });
+			break;
 
-		sf::Vector2f position_;
-		sf::Vector2f size_;
-	
-		Component(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
-			position_(position),
-			size_(size),
-			window_(window),
-			visibility(true),
-			activity(true),
-			event_(EventType::MouseLeave)
+		default:
+			break;
+		}
+	}
+
+	inline void Engine::setFocusOrder(Component* component, Component* after)
+	{
+		if (component->focus_engine_ != this or component == after)
 		{
+			return;
+		}
 
+		bool focused = focused_ == component;
+		removeFocusable(component);
+
+		component->focus_engine_ = this;
+		component->focus_prev_ = after;
+		component->focus_next_ = after != nullptr ? after->focus_next_ : focus_head_;
+		(component->focus_prev_ != nullptr ? component->focus_prev_->focus_next_ : focus_head_) = component;
+		(component->focus_next_ != nullptr ? component->focus_next_->focus_prev_ : focus_tail_) = component;
+
+		if (focused)
+		{
+			focused_ = component;
 		}
+	}
 
-		Component(sf::RenderWindow* window) :
-			position_({ 0, 0 }),
-			size_({ 0, 0 }),
-			window_(window),
-			visibility(true),
-			activity(true),
-			event_(EventType::MouseLeave)
+	inline void Engine::setFocusRing(sf::Color color, float thickness)
+	{
+		Component::focus_ring_color_ = color;
+		Component::focus_ring_thickness_ = thickness;
+	}
+
+	inline void Engine::addFocusable(Component* component)
+	{
+		component->focus_engine_ = this;
+		component->focus_prev_ = focus_tail_;
+		component->focus_next_ = nullptr;
+		(focus_tail_ != nullptr ? focus_tail_->focus_next_ : focus_head_) = component;
+		focus_tail_ = component;
+	}
+
+	inline void Engine::removeFocusable(Component* component)
+	{
+		(component->focus_prev_ != nullptr ? component->focus_prev_->focus_next_ : focus_head_) = component->focus_next_;
+		(component->focus_next_ != nullptr ? component->focus_next_->focus_prev_ : focus_tail_) = component->focus_prev_;
+		component->focus_prev_ = nullptr;
+		component->focus_next_ = nullptr;
+		component->focus_engine_ = nullptr;
+
+		if (focused_ == component)
 		{
+			// no focusChanged: the component may be half destroyed
+			focused_ = nullptr;
+		}
+	}
 
+	inline bool Engine::isBlocked(const Component* component) const
+	{
+		if (modals_.empty())
+		{
+			return false;
 		}
 
-		void notifyListeners() const
+		for (; component != nullptr; component = component->parent_)
 		{
-			for (auto listener : listeners_)
+			if (component == modals_.back())
 			{
-				listener->handleGUIEvent(event_, this);
+				return false;
 			}
 		}
+		return true;
+	}
 
-		virtual void click() const
+	inline void Engine::handlePointer(const sf::Event& event)
+	{
+		switch (event.type)
 		{
-			if (event_ != EventType::Click)
+		case sf::Event::MouseButtonPressed:
+		{
+			if (captured_ != nullptr)
 			{
-				event_ = EventType::Click;
-				notifyListeners();
-				std::cout << "click!\n";
+				// one button at a time
+				return;
 			}
-		}
 
-		virtual void enter() const
-		{
-			if (event_ != EventType::MouseEnter)
+			sf::Vector2f point = mapCursor(window_->getView());
+			Component* target = pick(point, PointerCategory::Button | PointerCategory::Drag | PointerCategory::DoubleClick);
+			if (target == nullptr)
 			{
-				event_ = EventType::MouseEnter;
-				notifyListeners();
-				std::cout << "enter!\n";
+				return;
+			}
+
+			captured_ = target;
+			captured_button_ = event.mouseButton.button;
+			press_point_ = point;
+			press_pixel_ = cursor_pixel_;
+			dragging_ = false;
+
+			// a press focuses the nearest focusable component it lands in
+			for (Component* component = target; component != nullptr; component = component->parent_)
+			{
+				if (component->focus_engine_ == this)
+				{
+					setFocus(component);
+					break;
+				}
+			}
+
+			if (target->pointer_categories_ & PointerCategory::Button)
+			{
+				dispatch(target, PointerEventType::Press, captured_button_, point);
 			}
+			break;
 		}
 
-		virtual void leave() const
+		case sf::Event::MouseMoved:
 		{
-			if (event_ != EventType::MouseLeave)
+			sf::Vector2f point = mapCursor(window_->getView());
+			setHovered(pick(point, PointerCategory::Hover));
+
+			if (captured_ == nullptr)
 			{
-				event_ = EventType::MouseLeave;
-				notifyListeners();
-				std::cout << "leave!\n";
+				if (Component* target = pick(point, PointerCategory::Motion))
+				{
+					dispatch(target, PointerEventType::Move, sf::Mouse::Left, point);
+				}
+				return;
+			}
+
+			Component* target = captured_;
+			if (!dragging_ and target->pointer_categories_ & PointerCategory::Drag)
+			{
+				sf::Vector2i moved = cursor_pixel_ - press_pixel_;
+				if (moved.x * moved.x + moved.y * moved.y >= drag_threshold_ * drag_threshold_)
+				{
+					dragging_ = true;
+					dispatch(target, PointerEventType::DragStart, captured_button_, press_point_);
+				}
+			}
+
+			if (dragging_)
+			{
+				sf::Vector2f from = press_point_;
+				sf::Vector2f to = point;
+				target->mapFromRoot(from);
+				target->mapFromRoot(to);
+				dispatch(target, PointerEventType::Drag, captured_button_, point, to - from);
+			}
+			if (target->pointer_categories_ & PointerCategory::Motion)
+			{
+				dispatch(target, PointerEventType::Move, captured_button_, point);
 			}
+			break;
 		}
 
-		virtual void update() const
+		case sf::Event::MouseButtonReleased:
 		{
-			if (activity)
+			if (captured_ == nullptr or event.mouseButton.button != captured_button_)
+			{
+				return;
+			}
+
+			Component* target = captured_;
+			captured_ = nullptr;
+			sf::Vector2f point = mapCursor(window_->getView());
+
+			if (target->pointer_categories_ & PointerCategory::Button)
+			{
+				dispatch(target, PointerEventType::Release, captured_button_, point);
+			}
+
+			if (dragging_)
 			{
-				sf::Vector2f mouse_pos = window_->mapPixelToCoords(sf::Mouse::getPosition(*window_));
+				dragging_ = false;
+				dispatch(target, PointerEventType::DragEnd, captured_button_, point);
+				return;
+			}
 
-				//std::cout << size_.x << "\t" << size_.y << "\t" << mouse_pos.x << "\t" << mouse_pos.y << std::endl;
+			sf::Vector2f local = point;
+			if (!target->mapFromRoot(local) or !sf::FloatRect(target->position_, target->size_).contains(local))
+			{
+				// released somewhere else: no click
+				return;
+			}
 
-				if (sf::IntRect(position_.x, position_.y, size_.x, size_.y).contains(mouse_pos.x, mouse_pos.y))
+			if (target->pointer_categories_ & PointerCategory::Button)
+			{
+				// an ancestor that stops the click while capturing also keeps
+				// it from the listeners
+				bool reached = dispatch(target, PointerEventType::Click, captured_button_, point);
+				if (reached and captured_button_ == sf::Mouse::Left)
 				{
-					if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
-					{
-						if (event_ != EventType::Click)
-						{
-							click();
-						}
-						
-					}
-					else
-					{
-						enter();
-					}
+					target->click();
 				}
-				else
+			}
+
+			float now = clock_.getTime();
+			sf::Vector2i moved = cursor_pixel_ - last_click_pixel_;
+			if (target == last_click_ and now - last_click_time_ <= double_click_time_ and moved.x * moved.x + moved.y * moved.y <= drag_threshold_ * drag_threshold_)
+			{
+				last_click_ = nullptr;
+				if (target->pointer_categories_ & PointerCategory::DoubleClick)
 				{
-					leave();
+					dispatch(target, PointerEventType::DoubleClick, captured_button_, point);
 				}
 			}
+			else
+			{
+				last_click_ = target;
+				last_click_pixel_ = cursor_pixel_;
+				last_click_time_ = now;
+			}
+			break;
 		}
 
-		virtual void setPosition(const sf::Vector2f position)
+		case sf::Event::MouseWheelScrolled:
 		{
-			position_ = position;
+			sf::Vector2f point = mapCursor(window_->getView());
+			if (Component* target = pick(point, PointerCategory::Wheel))
+			{
+				float delta = event.mouseWheelScroll.delta;
+				bool vertical = event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel;
+				dispatch(target, PointerEventType::Wheel, sf::Mouse::Middle, point, vertical ? sf::Vector2f(0, delta) : sf::Vector2f(delta, 0));
+			}
+			break;
 		}
 
-		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override = 0;
+		case sf::Event::MouseLeft:
+			setHovered(nullptr);
+			break;
 
-	public:
+		case sf::Event::LostFocus:
+			// the release will never arrive
+			cancelCapture();
+			break;
 
-		void addListener(IEventListener* listener)
-		{
-			listeners_.push_back(listener);
+		case sf::Event::KeyPressed:
+			handleKey(event.key);
+			break;
+
+		case sf::Event::TextEntered:
+			for (Component* component = focused_; component != nullptr; component = component->parent_)
+			{
+				if (component->textEvent(event.text.unicode))
+				{
+					break;
+				}
+			}
+			break;
+
+		default:
+			break;
 		}
+	}
 
-		void remoteListener(IEventListener* listener)
+	inline void Engine::update()
+	{
+		// finishes background loads and uploads a slice of decoded images
+		AssetLoader::get().pump();
+
+		std::uint32_t steps = clock_.tick();
+		float step = clock_.getStep();
+		for (std::uint32_t i = 0; i < steps; i++)
 		{
-			listeners_.remove(listener);
+			AnimationSystem::get().update(step);
 		}
 
-		sf::Vector2f getPosition() const
+		TweenSystem::get().update(steps * step, clock_.getAlpha() * step);
+		timers_.advance(steps * step);
+
+		// what gets drawn from here on is what the next events are tested against
+		draw_mark_ = Component::draw_counter_;
+	}
+
+	inline void Engine::addAnchored(Component* component)
+	{
+		component->anchor_engine_ = this;
+		component->anchor_index_ = anchored_.size();
+		anchored_.push_back(component);
+	}
+
+	inline void Engine::removeAnchored(Component* component)
+	{
+		// swap-remove keeps detaching O(1)
+		Component* last = anchored_.back();
+		anchored_[component->anchor_index_] = last;
+		last->anchor_index_ = component->anchor_index_;
+		anchored_.pop_back();
+		component->anchor_engine_ = nullptr;
+	}
+
+	inline void Engine::addPointerTarget(Component* component)
+	{
+		component->pointer_engine_ = this;
+		component->pointer_index_ = pointer_targets_.size();
+		pointer_targets_.push_back(component);
+	}
+
+	inline void Engine::removePointerTarget(Component* component)
+	{
+		Component* last = pointer_targets_.back();
+		pointer_targets_[component->pointer_index_] = last;
+		last->pointer_index_ = component->pointer_index_;
+		pointer_targets_.pop_back();
+		component->pointer_engine_ = nullptr;
+
+		if (captured_ == component)
 		{
-			return position_;
+			captured_ = nullptr;
+			dragging_ = false;
 		}
-
-		sf::Vector2f getSize() const
+		if (last_click_ == component)
 		{
-			return size_;
+			last_click_ = nullptr;
 		}
-
-		void setAligment(VerticalAligment aligment)
+		if (hovered_ == component)
 		{
-			sf::Vector2f position;
-			position.x = position_.x;
+			// no leave(): the component may be half destroyed
+			hovered_ = nullptr;
+		}
+		if (std::find(path_.begin(), path_.end(), component) != path_.end())
+		{
+			path_.clear();
+			path_target_ = nullptr;
+		}
+	}
 
-			switch (aligment)
+	inline void Component::attachAnchor()
+	{
+		if (anchor_engine_ == nullptr)
+		{
+			if (Engine* engine = Engine::find(window_))
 			{
-			case VerticalAligment::Top:
-				position.y = 0;
-				break;
-
-			case VerticalAligment::Bottom:
-				position.y = window_->getSize().y - size_.y;
-				break;
-
-			case VerticalAligment::Center:
-				position.y = window_->getSize().y / 2 - size_.y / 2;
-				break;
+				engine->addAnchored(this);
 			}
-
-			setPosition(position);
 		}
+	}
 
-		void setAligment(HorizontalAligment aligment)
+	inline void Component::detachAnchor()
+	{
+		if (anchor_engine_ != nullptr)
 		{
-			sf::Vector2f position;
-			position.y = position_.y;
+			anchor_engine_->removeAnchored(this);
+		}
+	}
 
-			switch (aligment)
+	inline void Component::attachFocus()
+	{
+		if (focus_engine_ == nullptr)
+		{
+			if (Engine* engine = Engine::find(window_))
 			{
-			case HorizontalAligment::Center:
-				position.x = window_->getSize().x / 2 - size_.x / 2;
-				break;
+				engine->addFocusable(this);
+			}
+		}
+	}
 
-			case HorizontalAligment::Left:
-				position.x = 0;
-				break;
+	inline void Component::detachFocus()
+	{
+		if (focus_engine_ != nullptr)
+		{
+			focus_engine_->removeFocusable(this);
+		}
+		has_focus_ = false;
+	}
 
-			case HorizontalAligment::Right:
-				position.x = window_->getSize().x - size_.x;
-				break;
+	inline void Component::attachPointer()
+	{
+		if (pointer_engine_ == nullptr)
+		{
+			if (Engine* engine = Engine::find(window_))
+			{
+				engine->addPointerTarget(this);
 			}
-
-			setPosition(position);
 		}
+	}
 
-	};
+	inline void Component::detachPointer()
+	{
+		if (pointer_engine_ != nullptr)
+		{
+			pointer_engine_->removePointerTarget(this);
+		}
+	}
 
 	class Button : public Component
 	{
@@ -235,7 +2215,19 @@ namespace gui
 		Button(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
 			Component(position, size, window)
 		{
-			
+			subscribe(PointerCategory::Button | PointerCategory::Hover);
+			setFocusable(true);
+		}
+
+		// Enter and Space press a focused button.
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			if (key.code == sf::Keyboard::Enter or key.code == sf::Keyboard::Space)
+			{
+				click();
+				return true;
+			}
+			return false;
 		}
 
 	public:
@@ -244,26 +2236,54 @@ namespace gui
 
 	};
 
-	class ColorButton : public Button
+	class ColorButton : public Button, public IAssetListener
 	{
 	private:
 
 		sf::Vector2<sf::Color> colors_;
 		mutable sf::RectangleShape rect_;
 
+		sf::Vector2f preferred_size_;
+
 		sf::Text text_;
-		sf::Font font_;
+		AssetLoader::Font font_;
+		sf::String string_;
+
+		float transition_;
+
+		// hover colors fade instead of snapping
+		void fadeTo(sf::Color color) const
+		{
+			ColorButton* self = const_cast<ColorButton*>(this);
+			TweenSystem::get().animate(self, TweenChannel::Color, { float(color.r), float(color.g), float(color.b), float(color.a) }, transition_);
+		}
+
+		// only a change of hover fades
+		void enter() const override
+		{
+			EventType previous = event_;
+			Component::enter();
+			if (event_ != previous)
+			{
+				fadeTo(colors_.y);
+			}
+		}
 
-		void enter() const override
+		void assetReady() override
 		{
-			Component::enter();
-			rect_.setFillColor(colors_.y);
+			text_.setFont(font_->font);
+			updatePosition();
+			requestRedraw();
 		}
 
 		void leave() const override
 		{
+			EventType previous = event_;
 			Component::leave();
-			rect_.setFillColor(colors_.x);
+			if (event_ != previous)
+			{
+				fadeTo(colors_.x);
+			}
 		}
 
 		void InitRect()
@@ -275,15 +2295,17 @@ namespace gui
 
 		void InitText()
 		{
-			font_.loadFromFile("res/font.ttf");
+			// the text shows up once the font is parsed in the background
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
 
-			text_.setFont(font_);
 			text_.setString("button");
 			text_.setCharacterSize(20.0f);
 			text_.setOrigin(text_.getLocalBounds().width / 2, text_.getLocalBounds().height / 2);
 
 			text_.setPosition(position_.x + size_.x / 2, position_.y + size_.y / 2);
 			text_.setFillColor(sf::Color::White);
+
+			font_->addListener(this);
 		}
 
 		void updatePosition()
@@ -292,42 +2314,112 @@ namespace gui
 			text_.setPosition(position_.x + size_.x / 2, position_.y + size_.y / 2);
 		}
 
+		void resize(sf::Vector2f size)
+		{
+			if (size != size_)
+			{
+				requestRedraw();
+				size_ = size;
+				rect_.setSize(size_);
+				text_.setPosition(position_.x + size_.x / 2, position_.y + size_.y / 2);
+				requestRedraw();
+			}
+		}
+
 	public:
 
 		ColorButton(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window):
 			Button(position, size, window),
-			colors_({sf::Color::Green, sf::Color::Red})
+			colors_({sf::Color::Green, sf::Color::Red}),
+			preferred_size_(size),
+			transition_(0.15f)
 		{
 			InitRect();
 			InitText();
 		}
 
+		~ColorButton() override
+		{
+			font_->removeListener(this);
+		}
+
 		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
 		{
+			if (isCulled(target, animation_state))
+			{
+				return;
+			}
+
 			Component::update();
 			if (visibility)
 			{
-				target.draw(rect_);
-				target.draw(text_);
+				target.draw(rect_, animation_state);
+				target.draw(text_, animation_state);
+				drawFocus(target, animation_state);
 			}
 		}
 
 		void setPosition(sf::Vector2f position) override
 		{
 			Component::setPosition(position);
+			rect_.setPosition(position_);
 			text_.setPosition(position_.x + size_.x / 2, position_.y + size_.y / 2);
 		}
 
-		void setText(const std::string text)
+		sf::Vector2f measure(sf::Vector2f) override
+		{
+			layout_dirty_ = false;
+			return preferred_size_;
+		}
+
+		void arrange(sf::Vector2f position, sf::Vector2f size) override
+		{
+			setPosition(position);
+			resize(size);
+		}
+
+		void setSize(sf::Vector2f size)
+		{
+			preferred_size_ = size;
+			resize(size);
+			invalidateLayout();
+		}
+
+		void setText(std::string_view text)
 		{
-			text_.setString(text);
+			utf8::decode(text, string_);
+			text_.setString(string_);
 			updatePosition();
+			requestRedraw();
+		}
+
+		// Any integer type; without the template an int would be ambiguous
+		// between the integer and the double overloads.
+		template <typename T>
+		std::enable_if_t<std::is_integral_v<T>> setNumber(T value)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, static_cast<std::conditional_t<std::is_unsigned_v<T>, unsigned long long, long long>>(value)));
+		}
+
+		// Shortest text that reads back as the same value.
+		void setNumber(double value)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, value));
+		}
+
+		void setNumber(double value, int precision)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, value, precision));
 		}
 
 		void setFontSize(const int size)
 		{
 			text_.setCharacterSize(size);
 			updatePosition();
+			requestRedraw();
 		}
 
 		void setColor(sf::Color disactive, sf::Color active)
@@ -335,49 +2427,199 @@ namespace gui
 			colors_ = { disactive, active };
 		}
 
+		// Seconds the hover colors take to blend; 0 switches at once.
+		void setTransition(float seconds)
+		{
+			transition_ = seconds;
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			sf::Color color = rect_.getFillColor();
+			switch (channel)
+			{
+			case TweenChannel::Size:
+				value[0] = size_.x;
+				value[1] = size_.y;
+				return 2;
+
+			case TweenChannel::Color:
+				value[0] = color.r;
+				value[1] = color.g;
+				value[2] = color.b;
+				value[3] = color.a;
+				return 4;
+
+			case TweenChannel::Opacity:
+				value[0] = color.a / 255.0f;
+				return 1;
+
+			default:
+				return Component::getTweenValue(channel, value);
+			}
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			switch (channel)
+			{
+			case TweenChannel::Size:
+				// the layout keeps the preferred size; only the drawn size moves
+				resize({ value[0], value[1] });
+				break;
+
+			case TweenChannel::Color:
+				rect_.setFillColor(sf::Color(sf::Uint8(value[0]), sf::Uint8(value[1]), sf::Uint8(value[2]), sf::Uint8(value[3])));
+				requestRedraw();
+				break;
+
+			case TweenChannel::Opacity:
+			{
+				sf::Uint8 alpha = sf::Uint8(std::clamp(value[0], 0.0f, 1.0f) * 255);
+				sf::Color fill = rect_.getFillColor();
+				sf::Color text = text_.getFillColor();
+				rect_.setFillColor(sf::Color(fill.r, fill.g, fill.b, alpha));
+				text_.setFillColor(sf::Color(text.r, text.g, text.b, alpha));
+				requestRedraw();
+				break;
+			}
+
+			default:
+				Component::setTweenValue(channel, value);
+				break;
+			}
+		}
+
 	};
 
-	class TextureButton : public Button
+	class TextureButton : public Button, public IAssetListener, public IAnimated
 	{
 	private:
 
-		sf::Vector2<sf::Texture*> textures_;
+		std::array<AssetLoader::Texture, 2> textures_;
+		std::array<SpriteSheet, 2> sheets_;
 		mutable sf::Sprite btn_sprite_;
+
+		// 0 normal, 1 hovered
+		mutable std::size_t state_;
+		mutable std::uint32_t frame_;
 		
+		// the sheet only restarts when the state actually changes
 		void enter() const override
 		{
 			Component::enter();
-			btn_sprite_.setTexture(*textures_.y);
+			if (state_ != 1)
+			{
+				showState();
+			}
 		}
 
 		void leave() const override
 		{
 			Component::leave();
-			btn_sprite_.setTexture(*textures_.x);
+			if (state_ != 0)
+			{
+				showState();
+			}
+		}
+
+		void assetReady() override
+		{
+			applyTexture();
+			requestRedraw();
+		}
+
+		// Restarts the animation of the state the button is now in.
+		void showState() const
+		{
+			state_ = event_ == EventType::MouseLeave ? 0 : 1;
+			AnimationSystem::get().play(const_cast<TextureButton*>(this), sheets_[state_]);
+		}
+
+		// Only the texture rect moves; the sprite keeps its atlas texture.
+		void setAnimationFrame(std::uint32_t frame) override
+		{
+			frame_ = frame;
+			const AssetLoader::Texture& texture = textures_[state_];
+			if (texture->ready and btn_sprite_.getTexture() == texture->region.texture)
+			{
+				btn_sprite_.setTextureRect(sheets_[state_].getFrame(texture->region.rect, frame_));
+			}
+			else
+			{
+				applyTexture();
+			}
+			requestRedraw();
+		}
+
+		// The placeholder is stretched over the button until the image has
+		// been uploaded.
+		void applyTexture() const
+		{
+			const AssetLoader::Texture& texture = textures_[state_];
+			if (texture->ready)
+			{
+				texture->region.applyTo(btn_sprite_);
+				btn_sprite_.setTextureRect(sheets_[state_].getFrame(texture->region.rect, frame_));
+				btn_sprite_.setScale(1, 1);
+			}
+			else if (const TextureAtlas::Region& placeholder = AssetLoader::get().getPlaceholder())
+			{
+				placeholder.applyTo(btn_sprite_);
+				btn_sprite_.setScale(size_.x / placeholder.rect.width, size_.y / placeholder.rect.height);
+			}
 		}
 
 		void InitTextures()
 		{
-			textures_.x->loadFromFile("res/btn_1.png");
-			textures_.y->loadFromFile("res/btn_2.png");
-			btn_sprite_.setTexture(*textures_.x);
+			// decoded in the background and packed into the shared atlas, so
+			// every TextureButton draws from one texture
+			textures_[0] = AssetLoader::get().loadTexture("res/btn_1.png");
+			textures_[1] = AssetLoader::get().loadTexture("res/btn_2.png");
+			applyTexture();
+
+			textures_[0]->addListener(this);
+			textures_[1]->addListener(this);
 		}
 
 	public: 
 
 		TextureButton(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
 			Button(position, size, window),
-			textures_({ new sf::Texture(), new sf::Texture() })
+			state_(0),
+			frame_(0)
 		{
 			InitTextures();
 		}
 
+		~TextureButton() override
+		{
+			textures_[0]->removeListener(this);
+			textures_[1]->removeListener(this);
+		}
+
 		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
 		{
+			if (isCulled(target, animation_state))
+			{
+				return;
+			}
+
 			Component::update();
 			if (visibility)
 			{
-				target.draw(btn_sprite_);
+				// only drawn textures stay resident; an evicted one shows the
+				// placeholder until it is reloaded
+				AssetLoader& loader = AssetLoader::get();
+				bool normal = loader.touch(textures_[0]);
+				bool hover = loader.touch(textures_[1]);
+				if (!normal or !hover)
+				{
+					applyTexture();
+				}
+
+				target.draw(btn_sprite_, animation_state);
+				drawFocus(target, animation_state);
 			}
 		}
 
@@ -387,16 +2629,58 @@ namespace gui
 			btn_sprite_.setPosition(position);
 		}
 
+		void setTextures(AssetLoader::Texture normal, AssetLoader::Texture hover)
+		{
+			textures_[0]->removeListener(this);
+			textures_[1]->removeListener(this);
+
+			textures_ = { normal, hover };
+			textures_[0]->addListener(this);
+			textures_[1]->addListener(this);
+			applyTexture();
+			requestRedraw();
+		}
+
+		// Either state can be a sprite sheet packed into its texture.
+		void setAnimation(SpriteSheet normal, SpriteSheet hover)
+		{
+			sheets_ = { normal, hover };
+			showState();
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			if (channel == TweenChannel::Opacity)
+			{
+				value[0] = btn_sprite_.getColor().a / 255.0f;
+				return 1;
+			}
+			return Component::getTweenValue(channel, value);
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			if (channel == TweenChannel::Opacity)
+			{
+				btn_sprite_.setColor(sf::Color(255, 255, 255, sf::Uint8(std::clamp(value[0], 0.0f, 1.0f) * 255)));
+				requestRedraw();
+				return;
+			}
+			Component::setTweenValue(channel, value);
+		}
+
 	};
 
-	class StatusButton : virtual public Button
+	class StatusButton : virtual public Button, public IAssetListener, public IAnimated
 	{
 	private:
 
-		std::vector<sf::Texture*> textures_;
+		std::vector<AssetLoader::Texture> textures_;
+		std::vector<SpriteSheet> sheets_;
 		mutable sf::Sprite btn_sprite_;
 
 		mutable int iter_num_;
+		mutable std::uint32_t frame_;
 
 		void click() const override
 		{
@@ -408,24 +2692,88 @@ namespace gui
 				iter_num_ = 0;
 			}
 
-			btn_sprite_.setTexture(*textures_[iter_num_]);
+			AnimationSystem::get().play(const_cast<StatusButton*>(this), sheets_[iter_num_]);
+		}
+
+		void assetReady() override
+		{
+			applyTexture();
+			requestRedraw();
+		}
+
+		// Only the texture rect moves; the sprite keeps its atlas texture.
+		void setAnimationFrame(std::uint32_t frame) override
+		{
+			frame_ = frame;
+			const AssetLoader::Texture& texture = textures_[iter_num_];
+			if (texture->ready and btn_sprite_.getTexture() == texture->region.texture)
+			{
+				btn_sprite_.setTextureRect(sheets_[iter_num_].getFrame(texture->region.rect, frame_));
+			}
+			else
+			{
+				applyTexture();
+			}
+			requestRedraw();
+		}
+
+		void applyTexture() const
+		{
+			const AssetLoader::Texture& texture = textures_[iter_num_];
+			if (texture->ready)
+			{
+				texture->region.applyTo(btn_sprite_);
+				btn_sprite_.setTextureRect(sheets_[iter_num_].getFrame(texture->region.rect, frame_));
+				btn_sprite_.setScale(1, 1);
+			}
+			else if (const TextureAtlas::Region& placeholder = AssetLoader::get().getPlaceholder())
+			{
+				placeholder.applyTo(btn_sprite_);
+				btn_sprite_.setScale(size_.x / placeholder.rect.width, size_.y / placeholder.rect.height);
+			}
 		}
 
 	public:
 
 		StatusButton(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
 			Button(position, size, window),
-			iter_num_(0)
+			iter_num_(0),
+			frame_(0)
 		{
 
 		}
 
+		~StatusButton() override
+		{
+			for (auto& texture : textures_)
+			{
+				texture->removeListener(this);
+			}
+		}
+
 		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
 		{
+			if (isCulled(target, animation_state))
+			{
+				return;
+			}
+
 			Component::update();
-			if (visibility)
+			if (visibility and !textures_.empty())
 			{
-				target.draw(btn_sprite_);
+				AssetLoader& loader = AssetLoader::get();
+				bool ready = true;
+				for (auto& texture : textures_)
+				{
+					ready = loader.touch(texture) and ready;
+				}
+				if (!ready)
+				{
+					applyTexture();
+				}
+
+				target.draw(btn_sprite_, animation_state);
+				drawFocus(target, animation_state);
 			}
 		}
 
@@ -435,19 +2783,55 @@ namespace gui
 			btn_sprite_.setPosition(position);
 		}
 
-		void addTexture(sf::Texture* texture)
+		// `sheet` animates the state when its texture holds several frames.
+		void addTexture(AssetLoader::Texture texture, SpriteSheet sheet = SpriteSheet())
 		{
 			textures_.push_back(texture);
+			sheets_.push_back(sheet);
 			if (btn_sprite_.getTexture() == nullptr)
 			{
 				std::cout << "YES\n";
-				btn_sprite_.setTexture(*textures_[iter_num_]);
+				AnimationSystem::get().play(this, sheets_[iter_num_]);
+			}
+			textures_.back()->addListener(this);
+		}
+
+		// Regions and textures the loader does not own are never evicted.
+		void addTexture(TextureAtlas::Region texture, SpriteSheet sheet = SpriteSheet())
+		{
+			addTexture(AssetLoader::wrap(texture), sheet);
+		}
+
+		// A standalone texture costs its own bind; prefer atlas regions.
+		void addTexture(sf::Texture* texture)
+		{
+			addTexture(TextureAtlas::Region{ texture, sf::IntRect(0, 0, texture->getSize().x, texture->getSize().y) });
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			if (channel == TweenChannel::Opacity)
+			{
+				value[0] = btn_sprite_.getColor().a / 255.0f;
+				return 1;
+			}
+			return Component::getTweenValue(channel, value);
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			if (channel == TweenChannel::Opacity)
+			{
+				btn_sprite_.setColor(sf::Color(255, 255, 255, sf::Uint8(std::clamp(value[0], 0.0f, 1.0f) * 255)));
+				requestRedraw();
+				return;
 			}
+			Component::setTweenValue(channel, value);
 		}
 
 	};
 
-	class TextBlock : public Component
+	class TextBlock : public Component, public IAssetListener
 	{
 	public:
 
@@ -456,48 +2840,63 @@ namespace gui
 	private:
 
 		mutable sf::Text text_;
-		sf::Font font_;
+		AssetLoader::Font font_;
+		sf::String string_;
 
 		sf::Vector2 <sf::Color> colors_;
 		
 		static inline constexpr sf::Vector2f m_sfml_bounds = { 2, 12 };
 
-		void InitText(const std::string text)
+		void InitText(std::string_view text)
 		{
-			font_.loadFromFile("res/font.ttf");
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
 
-			text_.setFont(font_);
-			text_.setString(text);
+			utf8::decode(text, string_);
+			text_.setString(string_);
 			text_.setCharacterSize(50.0f);
 
 			text_.setPosition(position_.x, position_.y);
 			size_ = { sf::Vector2f{text_.getLocalBounds().width, text_.getLocalBounds().height } + m_sfml_bounds };
 			text_.setFillColor(colors_.x);
+
+			font_->addListener(this);
+		}
+
+		// The size follows the text, which has no extent until the font is in.
+		void resizeToText()
+		{
+			sf::Vector2f size = sf::Vector2f{ text_.getLocalBounds().width, text_.getLocalBounds().height } + m_sfml_bounds;
+			requestRedraw();
+			if (size != size_)
+			{
+				size_ = size;
+				requestRedraw();
+				invalidateLayout();
+			}
+		}
+
+		void assetReady() override
+		{
+			text_.setFont(font_->font);
+			resizeToText();
 		}
 
+		// only sent while interactivity subscribes the block to hover
 		void enter() const override
 		{
 			Component::enter();
-
-			if (interactivity)
-			{
-				text_.setFillColor(colors_.y);
-			}		
+			text_.setFillColor(colors_.y);
 		}
 
 		void leave() const override
 		{
 			Component::leave();
-
-			if (interactivity)
-			{
-				text_.setFillColor(colors_.x);
-			}		
+			text_.setFillColor(colors_.x);
 		}
 
 	public:
 
-		TextBlock(sf::Vector2f position, std::string text, sf::RenderWindow* window) :
+		TextBlock(sf::Vector2f position, std::string_view text, sf::RenderWindow* window) :
 			Component(window),
 			colors_({ sf::Color::White, sf::Color::Black }),
 			interactivity(false)
@@ -506,31 +2905,118 @@ namespace gui
 			InitText(text);
 		}
 
+		~TextBlock() override
+		{
+			font_->removeListener(this);
+		}
+
 		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
 		{
+			if (isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			// interactivity is a plain field, so the hover subscription
+			// catches up with it here
+			if (interactivity != (getSubscription() & PointerCategory::Hover))
+			{
+				TextBlock* self = const_cast<TextBlock*>(this);
+				interactivity ? self->subscribe(PointerCategory::Hover) : self->unsubscribe();
+			}
+
 			Component::update();
 			if (visibility)
 			{
-				target.draw(text_);
+				target.draw(text_, animation_state);
 			}	
 		}
 
-		void setText(const std::string text)
+		void setText(std::string_view text)
 		{
-			text_.setString(text);
-			size_ = { sf::Vector2f{text_.getLocalBounds().width, text_.getLocalBounds().height } + m_sfml_bounds };
+			utf8::decode(text, string_);
+			text_.setString(string_);
+			resizeToText();
+		}
+
+		// Any integer type; without the template an int would be ambiguous
+		// between the integer and the double overloads.
+		template <typename T>
+		std::enable_if_t<std::is_integral_v<T>> setNumber(T value)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, static_cast<std::conditional_t<std::is_unsigned_v<T>, unsigned long long, long long>>(value)));
+		}
+
+		// Shortest text that reads back as the same value.
+		void setNumber(double value)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, value));
+		}
+
+		void setNumber(double value, int precision)
+		{
+			char buffer[32];
+			setText(formatNumber(buffer, value, precision));
 		}
 
 		void setColor(sf::Color disactive, sf::Color active)
 		{
 			colors_ = { disactive, active };
 			text_.setFillColor(colors_.x);
+			requestRedraw();
 		}
 
 		void setColor(sf::Color color)
 		{
 			colors_.x = color;
 			text_.setFillColor(colors_.x);
+			requestRedraw();
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			sf::Color color = text_.getFillColor();
+			switch (channel)
+			{
+			case TweenChannel::Color:
+				value[0] = color.r;
+				value[1] = color.g;
+				value[2] = color.b;
+				value[3] = color.a;
+				return 4;
+
+			case TweenChannel::Opacity:
+				value[0] = color.a / 255.0f;
+				return 1;
+
+			default:
+				return Component::getTweenValue(channel, value);
+			}
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			switch (channel)
+			{
+			case TweenChannel::Color:
+				text_.setFillColor(sf::Color(sf::Uint8(value[0]), sf::Uint8(value[1]), sf::Uint8(value[2]), sf::Uint8(value[3])));
+				requestRedraw();
+				break;
+
+			case TweenChannel::Opacity:
+			{
+				sf::Color color = text_.getFillColor();
+				text_.setFillColor(sf::Color(color.r, color.g, color.b, sf::Uint8(std::clamp(value[0], 0.0f, 1.0f) * 255)));
+				requestRedraw();
+				break;
+			}
+
+			default:
+				Component::setTweenValue(channel, value);
+				break;
+			}
 		}
 
 	};
@@ -546,6 +3032,12 @@ namespace gui
 		int progress_;
 		float step_;
 
+		// what the bar shows while it slides towards progress_
+		float shown_progress_;
+		float transition_;
+
+		sf::Vector2f preferred_size_;
+
 		void initRects()
 		{
 			border_.setPosition(position_);
@@ -558,22 +3050,43 @@ namespace gui
 			progress_bar_.setFillColor(sf::Color::Green);
 		}
 
+		void resize(sf::Vector2f size)
+		{
+			if (size != size_)
+			{
+				requestRedraw();
+				size_ = size;
+				step_ = (size_.x - 4) / range_.y;
+				border_.setSize(size_);
+				progress_bar_.setSize(sf::Vector2f(step_ * shown_progress_, size_.y - 4));
+				requestRedraw();
+			}
+		}
+
 	public:
 
 		ProgressBar(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
 			Component(position, size, window),
 			range_({ 0, 100 }),
 			progress_(0),
-			step_((size.x - 4) / range_.y)
+			step_((size.x - 4) / range_.y),
+			shown_progress_(0),
+			transition_(0.25f),
+			preferred_size_(size)
 		{
 			initRects();
 		}
 
 		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
 		{
+			if (isCulled(target, animation_state))
+			{
+				return;
+			}
+
 			Component::update();
-			target.draw(border_);
-			target.draw(progress_bar_);
+			target.draw(border_, animation_state);
+			target.draw(progress_bar_, animation_state);
 		}
 
 		void setPosition(const sf::Vector2f position) override
@@ -583,14 +3096,35 @@ namespace gui
 			progress_bar_.setPosition(position_ + sf::Vector2f(2, 2));
 		}
 
+		sf::Vector2f measure(sf::Vector2f) override
+		{
+			layout_dirty_ = false;
+			return preferred_size_;
+		}
+
+		void arrange(sf::Vector2f position, sf::Vector2f size) override
+		{
+			setPosition(position);
+			resize(size);
+		}
+
+		void setSize(sf::Vector2f size)
+		{
+			preferred_size_ = size;
+			resize(size);
+			invalidateLayout();
+		}
+
 		void setColor(sf::Color color)
 		{
 			progress_bar_.setFillColor(color);
+			requestRedraw();
 		}
 
 		void setOutlineColor(sf::Color color)
 		{
 			border_.setFillColor(color);
+			requestRedraw();
 		}
 
 		void setProgress(const int value)
@@ -601,7 +3135,7 @@ namespace gui
 			}
 
 			progress_ = value;
-			progress_bar_.setSize(sf::Vector2f(step_*progress_, size_.y - 4));
+			TweenSystem::get().animate(this, TweenChannel::Progress, { float(progress_) }, transition_);
 		}
 
 		int getProgress() const
@@ -609,5 +3143,62 @@ namespace gui
 			return progress_;
 		}
 
+		// Seconds the bar takes to slide to a new value; 0 jumps at once.
+		void setTransition(float seconds)
+		{
+			transition_ = seconds;
+		}
+
+		int getTweenValue(TweenChannel channel, float* value) const override
+		{
+			sf::Color color = progress_bar_.getFillColor();
+			switch (channel)
+			{
+			case TweenChannel::Size:
+				value[0] = size_.x;
+				value[1] = size_.y;
+				return 2;
+
+			case TweenChannel::Color:
+				value[0] = color.r;
+				value[1] = color.g;
+				value[2] = color.b;
+				value[3] = color.a;
+				return 4;
+
+			case TweenChannel::Progress:
+				value[0] = shown_progress_;
+				return 1;
+
+			default:
+				return Component::getTweenValue(channel, value);
+			}
+		}
+
+		void setTweenValue(TweenChannel channel, const float* value) override
+		{
+			switch (channel)
+			{
+			case TweenChannel::Size:
+				resize({ value[0], value[1] });
+				break;
+
+			case TweenChannel::Color:
+				progress_bar_.setFillColor(sf::Color(sf::Uint8(value[0]), sf::Uint8(value[1]), sf::Uint8(value[2]), sf::Uint8(value[3])));
+				requestRedraw();
+				break;
+
+			case TweenChannel::Progress:
+				shown_progress_ = value[0];
+				progress_bar_.setSize(sf::Vector2f(step_ * shown_progress_, size_.y - 4));
+				requestRedraw();
+				break;
+
+			default:
+				Component::setTweenValue(channel, value);
+				break;
+			}
+		}
+
 	};
 }
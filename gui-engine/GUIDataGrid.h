@@ -0,0 +1,383 @@
+#pragma once
+
+#include "GUICore.h"
+#include <vector>
+
+namespace gui
+{
+	class IGridDataSource
+	{
+	protected:
+
+		IGridDataSource()
+		{
+
+		}
+
+	public:
+
+		virtual std::size_t getRowCount() const = 0;
+		virtual std::size_t getColumnCount() const = 0;
+
+		// Returned text only has to stay valid until the next call.
+		virtual std::string_view getColumnTitle(std::size_t column) = 0;
+		virtual std::string_view getCellText(std::size_t row, std::size_t column) = 0;
+
+		// Called whenever a new range of rows scrolls into view. A source may
+		// fetch it in the background and report rows through isRowReady();
+		// the grid draws placeholders and polls until they arrive.
+		virtual void requestRows(std::size_t, std::size_t)
+		{
+
+		}
+
+		virtual bool isRowReady(std::size_t) const
+		{
+			return true;
+		}
+
+	};
+
+	class DataGrid : public Component, public IAssetListener
+	{
+	private:
+
+		IGridDataSource* source_;
+		AssetLoader::Font font_;
+
+		mutable GlyphBatch batch_;
+
+		std::vector<float> column_widths_;
+
+		// column_offsets_[i] is the left edge of column i, so finding the first
+		// visible column is a binary search
+		std::vector<double> column_offsets_;
+
+		float default_column_width_;
+		float row_height_;
+		float header_height_;
+
+		double scroll_x_;
+		double scroll_y_;
+
+		mutable bool batch_dirty_;
+		mutable bool rows_pending_;
+		mutable std::size_t requested_first_;
+		mutable std::size_t requested_count_;
+
+		sf::Color background_;
+		sf::Color text_color_;
+		sf::Color header_color_;
+		sf::Color header_background_;
+		sf::Color line_color_;
+
+		void updateOffsets(std::size_t from)
+		{
+			column_offsets_.resize(column_widths_.size() + 1);
+			for (std::size_t i = from; i < column_widths_.size(); i++)
+			{
+				column_offsets_[i + 1] = column_offsets_[i] + column_widths_[i];
+			}
+		}
+
+		std::size_t columnAt(double x) const
+		{
+			auto it = std::upper_bound(column_offsets_.begin(), column_offsets_.end(), x);
+			return it == column_offsets_.begin() ? 0 : (it - column_offsets_.begin()) - 1;
+		}
+
+		double contentWidth() const
+		{
+			return column_offsets_.back();
+		}
+
+		double contentHeight() const
+		{
+			return source_ != nullptr ? source_->getRowCount() * static_cast<double>(row_height_) : 0.0;
+		}
+
+		void assetReady() override
+		{
+			batch_.setFont(font_->font);
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void rebuildBatch() const
+		{
+			batch_.clear();
+			rows_pending_ = false;
+
+			batch_.appendRect(sf::FloatRect(position_, size_), background_);
+			if (source_ == nullptr)
+			{
+				return;
+			}
+
+			std::size_t columns = column_widths_.size();
+			std::size_t rows = source_->getRowCount();
+			if (columns == 0)
+			{
+				return;
+			}
+
+			std::size_t first_row = static_cast<std::size_t>(scroll_y_ / row_height_);
+			std::size_t last_row = std::min(rows, static_cast<std::size_t>((scroll_y_ + size_.y - header_height_) / row_height_) + 1);
+			std::size_t first_column = columnAt(scroll_x_);
+			std::size_t last_column = std::min(columns, columnAt(scroll_x_ + size_.x) + 1);
+
+			if (first_row < last_row and (first_row != requested_first_ or last_row - first_row != requested_count_))
+			{
+				requested_first_ = first_row;
+				requested_count_ = last_row - first_row;
+				source_->requestRows(requested_first_, requested_count_);
+			}
+
+			for (std::size_t row = first_row; row < last_row; row++)
+			{
+				float y = position_.y + header_height_ + static_cast<float>(row * static_cast<double>(row_height_) - scroll_y_);
+				bool ready = source_->isRowReady(row);
+				rows_pending_ = rows_pending_ or !ready;
+
+				for (std::size_t column = first_column; column < last_column; column++)
+				{
+					float x = position_.x + static_cast<float>(column_offsets_[column] - scroll_x_);
+					float width = column_widths_[column];
+
+					if (ready)
+					{
+						batch_.append(source_->getCellText(row, column), { x + 4, y + 4 }, text_color_, width - 8);
+					}
+					else
+					{
+						batch_.appendRect({ x + 4, y + row_height_ / 2 - 2, (width - 8) / 2, 4 }, line_color_);
+					}
+				}
+
+				batch_.appendRect({ position_.x, y + row_height_ - 1, size_.x, 1 }, line_color_);
+			}
+
+			// the header goes last so it covers the row scrolled halfway under it
+			batch_.appendRect({ position_.x, position_.y, size_.x, header_height_ }, header_background_);
+			for (std::size_t column = first_column; column < last_column; column++)
+			{
+				float x = position_.x + static_cast<float>(column_offsets_[column] - scroll_x_);
+				float width = column_widths_[column];
+
+				batch_.append(source_->getColumnTitle(column), { x + 4, position_.y + 4 }, header_color_, width - 8);
+				batch_.appendRect({ x + width - 1, position_.y, 1, size_.y }, line_color_);
+			}
+		}
+
+	protected:
+
+		// Rows with Up and Down, pages with Page Up and Page Down.
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			double page = size_.y - header_height_;
+			double y = scroll_y_;
+			switch (key.code)
+			{
+			case sf::Keyboard::Up:
+				scrollBy(0, -row_height_);
+				break;
+
+			case sf::Keyboard::Down:
+				scrollBy(0, row_height_);
+				break;
+
+			case sf::Keyboard::PageUp:
+				scrollBy(0, -page);
+				break;
+
+			case sf::Keyboard::PageDown:
+				scrollBy(0, page);
+				break;
+
+			default:
+				return false;
+			}
+			return scroll_y_ != y;
+		}
+
+		void pointerEvent(PointerEvent& event) override
+		{
+			if (event.type == PointerEventType::Wheel)
+			{
+				double x = scroll_x_;
+				double y = scroll_y_;
+				scrollBy(-event.delta.x * wheel_step, -event.delta.y * wheel_step);
+				if (scroll_x_ != x or scroll_y_ != y)
+				{
+					event.stopPropagation();
+				}
+			}
+		}
+
+	public:
+
+		DataGrid(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			Component(position, size, window),
+			source_(nullptr),
+			column_offsets_(1, 0.0),
+			default_column_width_(120),
+			row_height_(28),
+			header_height_(32),
+			scroll_x_(0),
+			scroll_y_(0),
+			batch_dirty_(true),
+			rows_pending_(false),
+			requested_first_(0),
+			requested_count_(0),
+			background_(sf::Color(30, 30, 30)),
+			text_color_(sf::Color::White),
+			header_color_(sf::Color::White),
+			header_background_(sf::Color(50, 50, 50)),
+			line_color_(sf::Color(70, 70, 70))
+		{
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
+
+			batch_.setCharacterSize(18);
+			font_->addListener(this);
+			subscribe(PointerCategory::Wheel);
+			setFocusable(true);
+		}
+
+		~DataGrid() override
+		{
+			font_->removeListener(this);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			// the batch needs the font even for its plain rects
+			if (!visibility or !font_->ready or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			Component::update();
+
+			if (batch_dirty_ or rows_pending_)
+			{
+				rebuildBatch();
+				batch_dirty_ = false;
+			}
+
+			sf::View previous = target.getView();
+			target.setView(clipView(target, animation_state.transform.transformRect(getBounds())));
+			target.draw(batch_, animation_state);
+			drawFocus(target, animation_state);
+			target.setView(previous);
+
+			// cached and scrolled parents only redraw what asks for it, so keep
+			// asking until the source delivers the rows
+			if (rows_pending_)
+			{
+				requestRedraw();
+			}
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			Component::setPosition(position);
+			batch_dirty_ = true;
+		}
+
+		void setDataSource(IGridDataSource* source)
+		{
+			source_ = source;
+			scroll_x_ = 0;
+			scroll_y_ = 0;
+			column_widths_.clear();
+			refresh();
+		}
+
+		// Call after the source's rows or columns changed.
+		void refresh()
+		{
+			if (source_ != nullptr)
+			{
+				column_widths_.resize(source_->getColumnCount(), default_column_width_);
+				updateOffsets(0);
+			}
+
+			requested_count_ = 0;
+			batch_dirty_ = true;
+			requestRedraw();
+			setScrollOffset(scroll_x_, scroll_y_);
+		}
+
+		void setColumnWidth(std::size_t column, float width)
+		{
+			if (column < column_widths_.size())
+			{
+				column_widths_[column] = std::max(width, 8.0f);
+				updateOffsets(column);
+				batch_dirty_ = true;
+				requestRedraw();
+			}
+		}
+
+		float getColumnWidth(std::size_t column) const
+		{
+			return column_widths_[column];
+		}
+
+		void scrollBy(float x, float y)
+		{
+			setScrollOffset(scroll_x_ + x, scroll_y_ + y);
+		}
+
+		void setScrollOffset(double x, double y)
+		{
+			x = std::clamp(x, 0.0, std::max(0.0, contentWidth() - size_.x));
+			y = std::clamp(y, 0.0, std::max(0.0, contentHeight() - (size_.y - header_height_)));
+
+			if (x != scroll_x_ or y != scroll_y_)
+			{
+				scroll_x_ = x;
+				scroll_y_ = y;
+				batch_dirty_ = true;
+				requestRedraw();
+			}
+		}
+
+		// Finds the body cell under a point given in the grid's parent space.
+		bool getCellAt(sf::Vector2f point, std::size_t& row, std::size_t& column) const
+		{
+			if (source_ == nullptr or !sf::FloatRect(position_, size_).contains(point) or point.y < position_.y + header_height_)
+			{
+				return false;
+			}
+
+			row = static_cast<std::size_t>((point.y - position_.y - header_height_ + scroll_y_) / row_height_);
+			column = columnAt(point.x - position_.x + scroll_x_);
+			return row < source_->getRowCount() and column < column_widths_.size();
+		}
+
+		void setRowHeight(float height)
+		{
+			row_height_ = height;
+			batch_dirty_ = true;
+			requestRedraw();
+			setScrollOffset(scroll_x_, scroll_y_);
+		}
+
+		void setFontSize(unsigned int size)
+		{
+			batch_.setCharacterSize(size);
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void setColor(sf::Color background, sf::Color text)
+		{
+			background_ = background;
+			text_color_ = text;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+	};
+}
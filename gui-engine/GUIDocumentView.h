@@ -0,0 +1,693 @@
+#pragma once
+
+#include "GUICore.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+
+namespace gui
+{
+	// Where the lines of a mapped text file start. The file is scanned in
+	// chunks by several threads at once, and chunks are merged in file order
+	// as they finish, so the first lines are usable long before a multi-GB
+	// file is done. Only every stride-th newline is stored; the rest are
+	// found again with memchr, which keeps the index at a few bytes per
+	// 64 lines.
+	class LineIndex
+	{
+	public:
+
+		static constexpr std::size_t stride = 64;
+		static constexpr std::uint64_t chunk_size = 4 << 20;
+
+	private:
+
+		struct Chunk
+		{
+			std::uint64_t begin = 0;
+			std::uint64_t end = 0;
+			// number of the chunk's first newline in the whole file
+			std::uint64_t first = 0;
+			std::uint64_t count = 0;
+			std::uint64_t last = 0;
+			// offsets of newlines 0, stride, 2 * stride... of the chunk
+			std::vector<std::uint64_t> marks;
+			bool done = false;
+		};
+
+		struct Scan
+		{
+			std::shared_ptr<MappedFile> file;
+			std::string path;
+			std::vector<Chunk> chunks;
+			std::atomic<std::size_t> next{ 0 };
+			std::atomic<bool> cancelled{ false };
+			// a chunk came up short: the file was cut while it was scanned
+			std::atomic<bool> truncated{ false };
+			std::mutex mutex;
+		};
+
+		std::shared_ptr<MappedFile> file_;
+		std::vector<Chunk> chunks_;
+
+		std::uint64_t newlines_;
+		std::uint64_t last_newline_;
+		// bytes covered by the merged chunks
+		std::uint64_t indexed_;
+
+		std::shared_ptr<Scan> scan_;
+		std::size_t merged_;
+		std::vector<std::thread> workers_;
+
+		// The scan is held by every worker, so it and its mapping outlive
+		// the index if the workers are still finishing a chunk. Chunks are
+		// read through a stream instead of the mapping: a file truncated
+		// mid-scan then gives a short read rather than a fault.
+		static void work(std::shared_ptr<Scan> scan)
+		{
+			std::ifstream stream(scan->path, std::ios::binary);
+			std::vector<char> buffer(stream ? chunk_size : 0);
+
+			while (!scan->cancelled)
+			{
+				std::size_t index = scan->next++;
+				if (index >= scan->chunks.size())
+				{
+					return;
+				}
+
+				Chunk chunk;
+				chunk.begin = scan->chunks[index].begin;
+				chunk.end = scan->chunks[index].end;
+
+				// a file no longer at its path cannot be truncated through it,
+				// so its mapping is safe to read
+				const char* data = reinterpret_cast<const char*>(scan->file->data()) + chunk.begin;
+				std::streamsize length = static_cast<std::streamsize>(chunk.end - chunk.begin);
+				if (stream)
+				{
+					stream.seekg(static_cast<std::streamoff>(chunk.begin));
+					stream.read(buffer.data(), length);
+					if (stream.gcount() != length)
+					{
+						scan->truncated = true;
+						scan->cancelled = true;
+						return;
+					}
+					data = buffer.data();
+				}
+
+				const char* it = data;
+				const char* end = data + length;
+				while ((it = static_cast<const char*>(std::memchr(it, '\n', end - it))) != nullptr)
+				{
+					std::uint64_t offset = chunk.begin + (it - data);
+					if (chunk.count % stride == 0)
+					{
+						chunk.marks.push_back(offset);
+					}
+					chunk.last = offset;
+					chunk.count++;
+					it++;
+				}
+				chunk.done = true;
+
+				std::lock_guard<std::mutex> lock(scan->mutex);
+				scan->chunks[index] = std::move(chunk);
+			}
+		}
+
+		void start(const std::string& path, std::uint64_t begin, std::uint64_t end)
+		{
+			auto scan = std::make_shared<Scan>();
+			scan->file = file_;
+			scan->path = path;
+			for (std::uint64_t offset = begin; offset < end; offset += chunk_size)
+			{
+				Chunk chunk;
+				chunk.begin = offset;
+				chunk.end = std::min(offset + chunk_size, end);
+				scan->chunks.push_back(std::move(chunk));
+			}
+
+			std::size_t count = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), scan->chunks.size());
+			for (std::size_t i = 0; i < count; i++)
+			{
+				workers_.emplace_back(&LineIndex::work, scan);
+			}
+
+			scan_ = std::move(scan);
+			merged_ = 0;
+		}
+
+		void stop()
+		{
+			if (scan_)
+			{
+				scan_->cancelled = true;
+			}
+			for (auto& worker : workers_)
+			{
+				worker.join();
+			}
+			workers_.clear();
+			scan_.reset();
+		}
+
+		// Offset of newline number `n`.
+		std::uint64_t newline(std::uint64_t n) const
+		{
+			auto it = std::upper_bound(chunks_.begin(), chunks_.end(), n, [](std::uint64_t n, const Chunk& chunk)
+			{
+				return n < chunk.first;
+			});
+			const Chunk& chunk = *(it - 1);
+
+			std::uint64_t local = n - chunk.first;
+			const char* data = reinterpret_cast<const char*>(file_->data());
+			const char* found = data + chunk.marks[local / stride];
+			for (std::uint64_t i = local % stride; i > 0; i--)
+			{
+				found = static_cast<const char*>(std::memchr(found + 1, '\n', chunk.end - (found + 1 - data)));
+			}
+			return found - data;
+		}
+
+	public:
+
+		LineIndex() :
+			newlines_(0),
+			last_newline_(0),
+			indexed_(0),
+			merged_(0)
+		{
+
+		}
+
+		~LineIndex()
+		{
+			stop();
+		}
+
+		LineIndex(const LineIndex&) = delete;
+		LineIndex& operator=(const LineIndex&) = delete;
+
+		// Maps the file and starts scanning it. An empty file fails to map
+		// but can still be followed with extend().
+		bool open(const std::string& path)
+		{
+			close();
+
+			auto file = std::make_shared<MappedFile>();
+			if (!file->open(path))
+			{
+				return false;
+			}
+
+			file_ = std::move(file);
+			start(path, 0, file_->size());
+			return true;
+		}
+
+		void close()
+		{
+			stop();
+			file_.reset();
+			chunks_.clear();
+			newlines_ = 0;
+			last_newline_ = 0;
+			indexed_ = 0;
+		}
+
+		// Picks up bytes appended since the last scan by mapping the file
+		// again and scanning just the new part. A file that shrank was
+		// rotated or truncated and is indexed from scratch. Returns whether
+		// anything changed.
+		bool extend(const std::string& path)
+		{
+			if (scan_)
+			{
+				return false;
+			}
+
+			std::error_code error;
+			std::uint64_t size = std::filesystem::file_size(path, error);
+			if (error or size == indexed_)
+			{
+				return false;
+			}
+			if (size < indexed_)
+			{
+				open(path);
+				return true;
+			}
+
+			auto file = std::make_shared<MappedFile>();
+			if (!file->open(path) or file->size() <= indexed_)
+			{
+				return false;
+			}
+
+			file_ = std::move(file);
+			start(path, indexed_, file_->size());
+			return true;
+		}
+
+		// Reading mapped pages past the end of a file that was cut short
+		// faults, so callers check the size again before reading. A file
+		// now smaller than the mapping is indexed from scratch; returns
+		// whether that happened.
+		bool verify(const std::string& path)
+		{
+			if (!file_)
+			{
+				return false;
+			}
+
+			std::error_code error;
+			std::uint64_t size = std::filesystem::file_size(path, error);
+			// a removed file stays mapped in full
+			if (error or size >= file_->size())
+			{
+				return false;
+			}
+
+			open(path);
+			return true;
+		}
+
+		// Merges the chunks that finished in file order. Call from the
+		// thread that reads the index; returns whether it grew.
+		bool pump()
+		{
+			if (!scan_)
+			{
+				return false;
+			}
+
+			if (scan_->truncated)
+			{
+				// the rest of the scan would never finish
+				std::string path = scan_->path;
+				open(path);
+				return true;
+			}
+
+			bool grew = false;
+			{
+				std::lock_guard<std::mutex> lock(scan_->mutex);
+				while (merged_ < scan_->chunks.size() and scan_->chunks[merged_].done)
+				{
+					Chunk& chunk = scan_->chunks[merged_++];
+					indexed_ = chunk.end;
+					grew = true;
+
+					if (chunk.count > 0)
+					{
+						chunk.first = newlines_;
+						newlines_ += chunk.count;
+						last_newline_ = chunk.last;
+						chunks_.push_back(std::move(chunk));
+					}
+				}
+			}
+
+			if (merged_ == scan_->chunks.size())
+			{
+				stop();
+			}
+			return grew;
+		}
+
+		bool isScanning() const
+		{
+			return static_cast<bool>(scan_);
+		}
+
+		// An unterminated last line counts; an empty one after the final
+		// newline does not.
+		std::uint64_t getLineCount() const
+		{
+			std::uint64_t last_start = newlines_ > 0 ? last_newline_ + 1 : 0;
+			return newlines_ + (indexed_ > last_start ? 1 : 0);
+		}
+
+		std::uint64_t getLineStart(std::uint64_t line) const
+		{
+			return line == 0 ? 0 : newline(line - 1) + 1;
+		}
+
+		const char* getData() const
+		{
+			return file_ ? reinterpret_cast<const char*>(file_->data()) : nullptr;
+		}
+
+		std::uint64_t getIndexedSize() const
+		{
+			return indexed_;
+		}
+
+	};
+
+	// Read-only view of a text file of any size, such as a multi-GB log.
+	// Lines are read straight from the mapping and only the rows in view are
+	// laid out. With follow on, appends to the file are indexed as they come
+	// and the view stays at the end if it was there.
+	class DocumentView : public Component, public IAssetListener
+	{
+	private:
+
+		static constexpr float padding = 4;
+		// a row lays out at most this much of a pathologically long line
+		static constexpr std::size_t max_line_bytes = 16 * 1024;
+
+		AssetLoader::Font font_;
+		mutable GlyphBatch batch_;
+		mutable bool batch_dirty_;
+
+		// merged while drawing, which may also move a following view down
+		mutable LineIndex index_;
+		std::string path_;
+
+		bool follow_;
+		float follow_interval_;
+		mutable TimerId follow_timer_;
+
+		float row_height_;
+		float scroll_x_;
+		mutable double scroll_y_;
+		// widest row laid out so far, which bounds horizontal scrolling
+		mutable float widest_;
+
+		sf::Color background_;
+		sf::Color text_color_;
+
+		double maxScrollY() const
+		{
+			return std::max(0.0, index_.getLineCount() * static_cast<double>(row_height_) - (size_.y - 2 * padding));
+		}
+
+		void assetReady() override
+		{
+			batch_.setFont(font_->font);
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		// The engine owns the timer, and it may not exist yet when following
+		// is switched on, so it is started from draw().
+		void startFollowing() const
+		{
+			Engine* engine = getEngine();
+			if (follow_ and engine != nullptr and !engine->isTimerActive(follow_timer_))
+			{
+				DocumentView* self = const_cast<DocumentView*>(this);
+				follow_timer_ = engine->setInterval(follow_interval_, [self]()
+				{
+					if (self->index_.extend(self->path_))
+					{
+						self->requestRedraw();
+					}
+				});
+			}
+		}
+
+		void stopFollowing()
+		{
+			Engine* engine = getEngine();
+			if (engine != nullptr)
+			{
+				engine->cancelTimer(follow_timer_);
+			}
+		}
+
+		void rebuildBatch() const
+		{
+			batch_.clear();
+			batch_.appendRect(sf::FloatRect(position_, size_), background_);
+
+			std::uint64_t count = index_.getLineCount();
+			std::uint64_t first = static_cast<std::uint64_t>(scroll_y_ / row_height_);
+			std::uint64_t last = std::min(first + static_cast<std::uint64_t>(std::ceil(size_.y / row_height_)) + 1, count);
+			if (first >= last)
+			{
+				return;
+			}
+
+			const char* data = index_.getData();
+			std::uint64_t end = index_.getIndexedSize();
+			std::uint64_t offset = index_.getLineStart(first);
+			float width = size_.x - 2 * padding + scroll_x_;
+
+			// rows after the first are found by scanning on from it
+			for (std::uint64_t line = first; line < last; line++)
+			{
+				const char* found = static_cast<const char*>(std::memchr(data + offset, '\n', end - offset));
+				std::uint64_t line_end = found != nullptr ? found - data : end;
+
+				float y = position_.y + padding + static_cast<float>(line * static_cast<double>(row_height_) - scroll_y_);
+				std::string_view text(data + offset, std::min<std::uint64_t>(line_end - offset, max_line_bytes));
+				batch_.append(text, { position_.x + padding - scroll_x_, y }, text_color_, width);
+				// the append stops at the right edge; scrolling needs the whole line
+				widest_ = std::max(widest_, batch_.measure(text));
+
+				offset = line_end + 1;
+			}
+		}
+
+	protected:
+
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			double page = size_.y - 2 * padding;
+			double y = scroll_y_;
+			switch (key.code)
+			{
+			case sf::Keyboard::Up:
+				scrollBy(0, -row_height_);
+				break;
+
+			case sf::Keyboard::Down:
+				scrollBy(0, row_height_);
+				break;
+
+			case sf::Keyboard::PageUp:
+				scrollBy(0, -page);
+				break;
+
+			case sf::Keyboard::PageDown:
+				scrollBy(0, page);
+				break;
+
+			case sf::Keyboard::Home:
+				setScrollOffset(scroll_x_, 0);
+				break;
+
+			case sf::Keyboard::End:
+				setScrollOffset(scroll_x_, maxScrollY());
+				break;
+
+			default:
+				return false;
+			}
+			return scroll_y_ != y;
+		}
+
+		void pointerEvent(PointerEvent& event) override
+		{
+			if (event.type == PointerEventType::Wheel)
+			{
+				float x = scroll_x_;
+				double y = scroll_y_;
+				scrollBy(-event.delta.x * wheel_step, -event.delta.y * wheel_step);
+				if (scroll_x_ != x or scroll_y_ != y)
+				{
+					event.stopPropagation();
+				}
+			}
+		}
+
+	public:
+
+		DocumentView(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			Component(position, size, window),
+			batch_dirty_(true),
+			follow_(false),
+			follow_interval_(0.25f),
+			row_height_(22),
+			scroll_x_(0),
+			scroll_y_(0),
+			widest_(0),
+			background_(sf::Color(30, 30, 30)),
+			text_color_(sf::Color::White)
+		{
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
+			if (font_->ready)
+			{
+				batch_.setFont(font_->font);
+			}
+			batch_.setCharacterSize(16);
+			font_->addListener(this);
+			subscribe(PointerCategory::Wheel);
+			setFocusable(true);
+		}
+
+		~DocumentView() override
+		{
+			stopFollowing();
+			font_->removeListener(this);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			// the batch needs the font even for its plain rects
+			if (!visibility or !font_->ready or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			Component::update();
+			startFollowing();
+
+			bool at_end = scroll_y_ >= maxScrollY();
+			if (index_.pump())
+			{
+				if (follow_ and at_end)
+				{
+					scroll_y_ = maxScrollY();
+				}
+				batch_dirty_ = true;
+			}
+
+			if (batch_dirty_)
+			{
+				if (index_.verify(path_))
+				{
+					scroll_y_ = std::min(scroll_y_, maxScrollY());
+				}
+				rebuildBatch();
+				batch_dirty_ = false;
+			}
+
+			sf::View previous = target.getView();
+			target.setView(clipView(target, animation_state.transform.transformRect(getBounds())));
+			target.draw(batch_, animation_state);
+			drawFocus(target, animation_state);
+			target.setView(previous);
+
+			// keep merging while the scan streams in
+			if (index_.isScanning())
+			{
+				requestRedraw();
+			}
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			Component::setPosition(position);
+			batch_dirty_ = true;
+		}
+
+		// Returns false if the file cannot be mapped; with follow on, an
+		// empty or missing file is still picked up once it has contents.
+		bool open(const std::string& path)
+		{
+			path_ = path;
+			scroll_x_ = 0;
+			scroll_y_ = 0;
+			widest_ = 0;
+			batch_dirty_ = true;
+			requestRedraw();
+			return index_.open(path);
+		}
+
+		void close()
+		{
+			index_.close();
+			path_.clear();
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		// Watches the file for appends every `interval` seconds.
+		void setFollow(bool follow, float interval = 0.25f)
+		{
+			stopFollowing();
+			follow_ = follow;
+			follow_interval_ = interval;
+			requestRedraw();
+		}
+
+		bool isFollowing() const
+		{
+			return follow_;
+		}
+
+		// Lines indexed so far; grows while the file is still being scanned.
+		std::uint64_t getLineCount() const
+		{
+			return index_.getLineCount();
+		}
+
+		bool isIndexing() const
+		{
+			return index_.isScanning();
+		}
+
+		void scrollBy(float x, float y)
+		{
+			setScrollOffset(scroll_x_ + x, scroll_y_ + y);
+		}
+
+		void setScrollOffset(float x, double y)
+		{
+			x = std::clamp(x, 0.0f, std::max(0.0f, widest_ - (size_.x - 2 * padding)));
+			y = std::clamp(y, 0.0, maxScrollY());
+
+			if (x != scroll_x_ or y != scroll_y_)
+			{
+				scroll_x_ = x;
+				scroll_y_ = y;
+				batch_dirty_ = true;
+				requestRedraw();
+			}
+		}
+
+		void scrollToLine(std::uint64_t line)
+		{
+			setScrollOffset(scroll_x_, line * static_cast<double>(row_height_));
+		}
+
+		void setRowHeight(float height)
+		{
+			row_height_ = height;
+			batch_dirty_ = true;
+			requestRedraw();
+			setScrollOffset(scroll_x_, scroll_y_);
+		}
+
+		void setFontSize(unsigned int size)
+		{
+			batch_.setCharacterSize(size);
+			widest_ = 0;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void setColor(sf::Color background, sf::Color text)
+		{
+			background_ = background;
+			text_color_ = text;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+	};
+}
@@ -0,0 +1,480 @@
+#pragma once
+
+#include "GUICore.h"
+#include <array>
+#include <string>
+#include <cmath>
+
+namespace gui
+{
+	// Hex and ASCII dump of a binary file of any size. The file is read
+	// through a PagedFile, so only the pages under the visible rows are
+	// mapped, and any offset is one multiplication away. Rows are formatted
+	// from lookup tables straight into glyph quads; the cost of a frame
+	// depends on the rows in view, never on the file.
+	class HexView : public Component, public IAssetListener
+	{
+	private:
+
+		static constexpr std::uint64_t bytes_per_row = 16;
+		static constexpr float padding = 4;
+
+		// in cells from the left edge of the hex column
+		static constexpr unsigned int hex_cells = bytes_per_row * 3 + 1;
+
+		AssetLoader::Font font_;
+		mutable GlyphBatch batch_;
+		mutable bool batch_dirty_;
+
+		// drawing maps the pages it reads
+		mutable PagedFile file_;
+
+		// the printable ASCII glyphs, fetched from the font once per size
+		mutable std::array<sf::Glyph, 128> glyphs_;
+		mutable bool glyphs_dirty_;
+		// widest hex digit and widest printable character
+		mutable float digit_width_;
+		mutable float char_width_;
+
+		unsigned int offset_digits_;
+		float row_height_;
+		double scroll_y_;
+		std::uint64_t cursor_;
+
+		sf::Color background_;
+		sf::Color text_color_;
+		sf::Color offset_color_;
+		sf::Color cursor_color_;
+
+		// both digits of every byte value
+		static const std::array<std::array<char, 2>, 256>& hexTable()
+		{
+			static const std::array<std::array<char, 2>, 256> table = []()
+			{
+				const char* digits = "0123456789abcdef";
+				std::array<std::array<char, 2>, 256> table;
+				for (std::size_t i = 0; i < table.size(); i++)
+				{
+					table[i] = { digits[i >> 4], digits[i & 0xF] };
+				}
+				return table;
+			}();
+			return table;
+		}
+
+		// what the ASCII column shows for every byte value
+		static const std::array<char, 256>& charTable()
+		{
+			static const std::array<char, 256> table = []()
+			{
+				std::array<char, 256> table;
+				for (std::size_t i = 0; i < table.size(); i++)
+				{
+					table[i] = i >= 0x20 and i < 0x7F ? static_cast<char>(i) : '.';
+				}
+				return table;
+			}();
+			return table;
+		}
+
+		void loadGlyphs() const
+		{
+			digit_width_ = 0;
+			char_width_ = 0;
+			for (sf::Uint32 c = 0x20; c < 0x7F; c++)
+			{
+				glyphs_[c] = batch_.getGlyph(c);
+				char_width_ = std::max(char_width_, glyphs_[c].advance);
+			}
+			for (char c : std::string_view("0123456789abcdef"))
+			{
+				digit_width_ = std::max(digit_width_, glyphs_[c].advance);
+			}
+			glyphs_dirty_ = false;
+		}
+
+		float hexLeft() const
+		{
+			return position_.x + padding + (offset_digits_ + 2) * digit_width_;
+		}
+
+		float charLeft() const
+		{
+			return hexLeft() + (hex_cells + 1) * digit_width_;
+		}
+
+		float byteX(std::uint64_t column) const
+		{
+			// an extra cell splits the row in halves of eight
+			return hexLeft() + (column * 3 + (column >= bytes_per_row / 2 ? 1 : 0)) * digit_width_;
+		}
+
+		std::uint64_t rowCount() const
+		{
+			return (file_.size() + bytes_per_row - 1) / bytes_per_row;
+		}
+
+		std::uint64_t visibleRows() const
+		{
+			return std::max<std::uint64_t>(1, static_cast<std::uint64_t>((size_.y - 2 * padding) / row_height_));
+		}
+
+		double maxScrollOffset() const
+		{
+			return std::max(0.0, rowCount() * static_cast<double>(row_height_) - (size_.y - 2 * padding));
+		}
+
+		// Byte under a point in the view's parent space, in either column.
+		bool offsetAt(sf::Vector2f point, std::uint64_t& offset) const
+		{
+			double y = point.y - position_.y - padding + scroll_y_;
+			if (y < 0 or digit_width_ <= 0)
+			{
+				return false;
+			}
+
+			std::uint64_t column;
+			if (point.x >= charLeft())
+			{
+				column = static_cast<std::uint64_t>((point.x - charLeft()) / char_width_);
+			}
+			else if (point.x >= hexLeft())
+			{
+				std::uint64_t cell = static_cast<std::uint64_t>((point.x - hexLeft()) / digit_width_);
+				column = cell < bytes_per_row / 2 * 3 ? cell / 3 : (cell - 1) / 3;
+			}
+			else
+			{
+				return false;
+			}
+
+			offset = static_cast<std::uint64_t>(y / row_height_) * bytes_per_row + std::min(column, bytes_per_row - 1);
+			return offset < file_.size();
+		}
+
+		void moveCursor(std::uint64_t offset)
+		{
+			if (!file_.isOpen())
+			{
+				return;
+			}
+
+			cursor_ = std::min(offset, file_.size() - 1);
+
+			double top = (cursor_ / bytes_per_row) * static_cast<double>(row_height_);
+			if (top < scroll_y_)
+			{
+				setScrollOffset(top);
+			}
+			else if (top + row_height_ > scroll_y_ + size_.y - 2 * padding)
+			{
+				setScrollOffset(top + row_height_ - (size_.y - 2 * padding));
+			}
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void assetReady() override
+		{
+			batch_.setFont(font_->font);
+			glyphs_dirty_ = true;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void rebuildBatch() const
+		{
+			if (glyphs_dirty_)
+			{
+				loadGlyphs();
+			}
+
+			batch_.clear();
+			batch_.appendRect(sf::FloatRect(position_, size_), background_);
+			if (!file_.isOpen())
+			{
+				return;
+			}
+
+			const auto& hex = hexTable();
+			const auto& chars = charTable();
+			float offset_left = position_.x + padding;
+			float hex_left = hexLeft();
+			float char_left = charLeft();
+
+			std::uint64_t first = static_cast<std::uint64_t>(scroll_y_ / row_height_);
+			std::uint64_t last = std::min(first + static_cast<std::uint64_t>(std::ceil(size_.y / row_height_)) + 1, rowCount());
+
+			for (std::uint64_t row = first; row < last; row++)
+			{
+				std::uint64_t offset = row * bytes_per_row;
+				std::size_t available;
+				// pages are whole rows, so a row never spans two of them
+				const std::uint8_t* bytes = file_.read(offset, available);
+				if (bytes == nullptr)
+				{
+					continue;
+				}
+				std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(available, bytes_per_row));
+
+				float y = position_.y + padding + static_cast<float>(row * static_cast<double>(row_height_) - scroll_y_);
+				float baseline = std::floor(y + batch_.getCharacterSize());
+
+				if (cursor_ / bytes_per_row == row)
+				{
+					std::uint64_t column = cursor_ % bytes_per_row;
+					batch_.appendRect({ byteX(column) - digit_width_ / 2, y, digit_width_ * 3, row_height_ }, cursor_color_);
+					batch_.appendRect({ char_left + column * char_width_, y, char_width_, row_height_ }, cursor_color_);
+				}
+
+				for (unsigned int digit = 0; digit < offset_digits_; digit++)
+				{
+					std::uint64_t nibble = (offset >> ((offset_digits_ - 1 - digit) * 4)) & 0xF;
+					batch_.appendGlyph(glyphs_["0123456789abcdef"[nibble]], offset_left + digit * digit_width_, baseline, offset_color_);
+				}
+
+				for (std::size_t i = 0; i < count; i++)
+				{
+					const auto& digits = hex[bytes[i]];
+					float x = hex_left + (i * 3 + (i >= bytes_per_row / 2 ? 1 : 0)) * digit_width_;
+					batch_.appendGlyph(glyphs_[digits[0]], x, baseline, text_color_);
+					batch_.appendGlyph(glyphs_[digits[1]], x + digit_width_, baseline, text_color_);
+					batch_.appendGlyph(glyphs_[chars[bytes[i]]], char_left + i * char_width_, baseline, text_color_);
+				}
+			}
+		}
+
+	protected:
+
+		// Arrows move the cursor by a byte or a row, Page Up and Page Down by
+		// a screen, Home and End to the row's ends or with Ctrl the file's.
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			if (!file_.isOpen())
+			{
+				return false;
+			}
+
+			std::uint64_t cursor = cursor_;
+			std::uint64_t page = visibleRows() * bytes_per_row;
+			switch (key.code)
+			{
+			case sf::Keyboard::Left:
+				moveCursor(cursor_ - std::min<std::uint64_t>(cursor_, 1));
+				break;
+
+			case sf::Keyboard::Right:
+				moveCursor(cursor_ + 1);
+				break;
+
+			case sf::Keyboard::Up:
+				moveCursor(cursor_ >= bytes_per_row ? cursor_ - bytes_per_row : cursor_);
+				break;
+
+			case sf::Keyboard::Down:
+				moveCursor(cursor_ + bytes_per_row < file_.size() ? cursor_ + bytes_per_row : cursor_);
+				break;
+
+			case sf::Keyboard::PageUp:
+				moveCursor(cursor_ - std::min(cursor_ / bytes_per_row, page / bytes_per_row) * bytes_per_row);
+				break;
+
+			case sf::Keyboard::PageDown:
+				moveCursor(cursor_ + std::min((file_.size() - 1 - cursor_) / bytes_per_row, page / bytes_per_row) * bytes_per_row);
+				break;
+
+			case sf::Keyboard::Home:
+				moveCursor(key.control ? 0 : cursor_ - cursor_ % bytes_per_row);
+				break;
+
+			case sf::Keyboard::End:
+				moveCursor(key.control ? file_.size() - 1 : cursor_ - cursor_ % bytes_per_row + bytes_per_row - 1);
+				break;
+
+			default:
+				return false;
+			}
+			return cursor_ != cursor;
+		}
+
+		void pointerEvent(PointerEvent& event) override
+		{
+			if (event.type == PointerEventType::Wheel)
+			{
+				double y = scroll_y_;
+				scrollBy(-event.delta.y * wheel_step);
+				if (scroll_y_ != y)
+				{
+					event.stopPropagation();
+				}
+			}
+			else if (event.type == PointerEventType::Press and event.button == sf::Mouse::Left)
+			{
+				std::uint64_t offset;
+				if (offsetAt(event.position, offset))
+				{
+					moveCursor(offset);
+				}
+			}
+		}
+
+	public:
+
+		HexView(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			Component(position, size, window),
+			batch_dirty_(true),
+			glyphs_dirty_(true),
+			digit_width_(0),
+			char_width_(0),
+			offset_digits_(8),
+			row_height_(22),
+			scroll_y_(0),
+			cursor_(0),
+			background_(sf::Color(30, 30, 30)),
+			text_color_(sf::Color::White),
+			offset_color_(sf::Color(140, 140, 140)),
+			cursor_color_(sf::Color(60, 90, 160))
+		{
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
+			if (font_->ready)
+			{
+				batch_.setFont(font_->font);
+			}
+			batch_.setCharacterSize(16);
+			font_->addListener(this);
+			subscribe(PointerCategory::Button | PointerCategory::Wheel);
+			setFocusable(true);
+		}
+
+		~HexView() override
+		{
+			font_->removeListener(this);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			// the batch needs the font even for its plain rects
+			if (!visibility or !font_->ready or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			Component::update();
+
+			if (batch_dirty_)
+			{
+				rebuildBatch();
+				batch_dirty_ = false;
+			}
+
+			sf::View previous = target.getView();
+			target.setView(clipView(target, animation_state.transform.transformRect(getBounds())));
+			target.draw(batch_, animation_state);
+			drawFocus(target, animation_state);
+			target.setView(previous);
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			Component::setPosition(position);
+			batch_dirty_ = true;
+		}
+
+		bool open(const std::string& path)
+		{
+			bool opened = file_.open(path);
+
+			// wide enough for the last offset, and never less than 8 digits
+			offset_digits_ = 8;
+			while (offset_digits_ < 16 and (file_.size() >> (offset_digits_ * 4)) > 0)
+			{
+				offset_digits_++;
+			}
+
+			scroll_y_ = 0;
+			cursor_ = 0;
+			batch_dirty_ = true;
+			requestRedraw();
+			return opened;
+		}
+
+		void close()
+		{
+			file_.close();
+			scroll_y_ = 0;
+			cursor_ = 0;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		// Puts the cursor on `offset` and its row in the middle of the view.
+		void jumpTo(std::uint64_t offset)
+		{
+			if (!file_.isOpen())
+			{
+				return;
+			}
+
+			cursor_ = std::min(offset, file_.size() - 1);
+			setScrollOffset((cursor_ / bytes_per_row) * static_cast<double>(row_height_) - (size_.y - row_height_) / 2);
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		std::uint64_t getCursor() const
+		{
+			return cursor_;
+		}
+
+		std::uint64_t getFileSize() const
+		{
+			return file_.size();
+		}
+
+		void scrollBy(float pixels)
+		{
+			setScrollOffset(scroll_y_ + pixels);
+		}
+
+		void setScrollOffset(double offset)
+		{
+			offset = std::clamp(offset, 0.0, maxScrollOffset());
+			if (offset != scroll_y_)
+			{
+				scroll_y_ = offset;
+				batch_dirty_ = true;
+				requestRedraw();
+			}
+		}
+
+		double getScrollOffset() const
+		{
+			return scroll_y_;
+		}
+
+		void setRowHeight(float height)
+		{
+			row_height_ = height;
+			batch_dirty_ = true;
+			requestRedraw();
+			setScrollOffset(scroll_y_);
+		}
+
+		void setFontSize(unsigned int size)
+		{
+			batch_.setCharacterSize(size);
+			glyphs_dirty_ = true;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		void setColor(sf::Color background, sf::Color text)
+		{
+			background_ = background;
+			text_color_ = text;
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+	};
+}
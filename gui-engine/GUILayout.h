@@ -0,0 +1,1141 @@
+#pragma once
+
+#include "GUICore.h"
+#include "GUIRenderCache.h"
+#include <vector>
+#include <array>
+#include <algorithm>
+
+namespace gui
+{
+	enum class Orientation
+	{
+		Horizontal,
+		Vertical
+	};
+
+	class Container : public Component
+	{
+	private:
+
+		struct MeasureEntry
+		{
+			sf::Vector2f available;
+			sf::Vector2f size;
+		};
+
+		// a few constraints cover the usual measure-then-arrange round trips
+		std::array<MeasureEntry, 4> measure_cache_;
+		std::size_t measure_cache_size_;
+		std::size_t measure_cache_next_;
+
+		sf::Transform transform_;
+
+		// children are positioned relative to the container, so moving it
+		// only marks these stale instead of rearranging the subtree
+		mutable sf::Transform world_;
+		mutable sf::Transform inverse_world_;
+		mutable bool world_dirty_;
+
+		bool cached_;
+		mutable bool cache_valid_;
+		mutable std::size_t cache_slot_;
+		mutable sf::Sprite cache_sprite_;
+
+		void updateWorldTransform() const
+		{
+			world_ = parent_ != nullptr ? parent_->getWorldTransform() : sf::Transform::Identity;
+			world_ *= getLocalTransform();
+			inverse_world_ = world_.getInverse();
+			world_dirty_ = false;
+		}
+
+		void drawCached(sf::RenderTarget& target, sf::RenderStates animation_state) const
+		{
+			sf::Vector2u size(static_cast<unsigned int>(std::ceil(size_.x)), static_cast<unsigned int>(std::ceil(size_.y)));
+			if (size.x == 0 or size.y == 0)
+			{
+				return;
+			}
+
+			bool fresh;
+			sf::RenderTexture* texture = RenderCache::get().acquire(this, cache_slot_, size, fresh);
+			if (texture == nullptr)
+			{
+				return;
+			}
+
+			if (!fresh and cache_valid_)
+			{
+				// keep the children pickable; a hover change invalidates the cache
+				update();
+			}
+
+			if (fresh or !cache_valid_)
+			{
+				texture->clear(sf::Color::Transparent);
+				for (auto child : children_)
+				{
+					texture->draw(*child);
+				}
+				texture->display();
+
+				cache_valid_ = true;
+				RenderCache::get().countRender();
+			}
+			else
+			{
+				RenderCache::get().countHit();
+			}
+
+			// the texture holds premultiplied colors after alpha blending into it
+			if (animation_state.blendMode == sf::BlendAlpha)
+			{
+				animation_state.blendMode = sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+			}
+
+			cache_sprite_.setTexture(texture->getTexture(), true);
+			target.draw(cache_sprite_, animation_state);
+		}
+
+	protected:
+
+		std::vector<Component*> children_;
+
+		sf::Vector2f padding_;
+		float spacing_;
+
+		bool fixed_size_;
+		bool arrange_dirty_;
+
+		Container(sf::RenderWindow* window) :
+			Component(window),
+			measure_cache_size_(0),
+			measure_cache_next_(0),
+			world_dirty_(true),
+			cached_(false),
+			cache_valid_(false),
+			cache_slot_(static_cast<std::size_t>(-1)),
+			padding_({ 0, 0 }),
+			spacing_(0),
+			fixed_size_(false),
+			arrange_dirty_(true)
+		{
+
+		}
+
+		virtual sf::Vector2f measureContent(sf::Vector2f available) = 0;
+		virtual void arrangeContent() = 0;
+
+		virtual void childAdded(std::size_t)
+		{
+
+		}
+
+		virtual void childRemoved(std::size_t)
+		{
+
+		}
+
+		void childRedrawRequested(const sf::FloatRect& area) override
+		{
+			cache_valid_ = false;
+
+			if (parent_ != nullptr)
+			{
+				parent_->childRedrawRequested(getLocalTransform().transformRect(area));
+			}
+		}
+
+		void childLayoutChanged() override
+		{
+			arrange_dirty_ = true;
+
+			// a fixed size keeps the change from reaching the ancestors
+			if (!fixed_size_)
+			{
+				invalidateLayout();
+			}
+		}
+
+		void updateLayout()
+		{
+			// a nested container was already given its size by the parent's arrange
+			if (parent_ == nullptr)
+			{
+				if (!fixed_size_)
+				{
+					size_ = measure(sf::Vector2f(window_->getSize()) - position_);
+				}
+				else
+				{
+					// no parent measures a fixed root, so nothing else clears it
+					layout_dirty_ = false;
+				}
+			}
+
+			// children that move or resize request their own redraw, which
+			// also drops the render cache
+			arrangeContent();
+			arrange_dirty_ = false;
+		}
+
+		sf::Vector2f contentOrigin() const
+		{
+			return padding_;
+		}
+
+		sf::Vector2f contentSize() const
+		{
+			return size_ - padding_ - padding_;
+		}
+
+		// Lets containers that draw children off-window (ScrollView) keep
+		// them pickable separately from drawing.
+		static void updateChild(const Component* child)
+		{
+			child->update();
+		}
+
+		bool toChildSpace(sf::Vector2f& point) const override
+		{
+			point = getLocalTransform().getInverse().transformPoint(point);
+			return true;
+		}
+
+		void fromChildSpace(sf::Vector2f& point) const override
+		{
+			point = getLocalTransform().transformPoint(point);
+		}
+
+		// Children in reverse, so the last drawn is tested first; the
+		// container itself only if none of them takes the point.
+		Component* hitTest(sf::Vector2f point, PointerCategory categories) override
+		{
+			if (!visibility)
+			{
+				return nullptr;
+			}
+
+			sf::Vector2f local = point;
+			if (toChildSpace(local))
+			{
+				for (auto it = children_.rbegin(); it != children_.rend(); ++it)
+				{
+					if (Component* hit = (*it)->hitTest(local, categories))
+					{
+						return hit;
+					}
+				}
+			}
+			return Component::hitTest(point, categories);
+		}
+
+		// Keeps the subtree pickable without drawing it, for when its pixels
+		// come from the render cache.
+		void update() const override
+		{
+			for (auto child : children_)
+			{
+				if (child->visibility)
+				{
+					updateChild(child);
+				}
+			}
+		}
+
+		sf::Vector2f shrinkAvailable(sf::Vector2f available) const
+		{
+			return { std::max(available.x - 2 * padding_.x, 0.0f), std::max(available.y - 2 * padding_.y, 0.0f) };
+		}
+
+	public:
+
+		~Container() override
+		{
+			RenderCache::get().release(this, cache_slot_);
+
+			for (auto child : children_)
+			{
+				delete child;
+			}
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			if (layout_dirty_ or arrange_dirty_)
+			{
+				// layout is deferred to the first draw after a change
+				const_cast<Container*>(this)->updateLayout();
+			}
+
+			if (visibility and !isCulled(target, animation_state))
+			{
+				markDrawn();
+				animation_state.transform *= getLocalTransform();
+				if (cached_)
+				{
+					drawCached(target, animation_state);
+					return;
+				}
+
+				for (auto child : children_)
+				{
+					target.draw(*child, animation_state);
+				}
+			}
+		}
+
+		sf::Vector2f measure(sf::Vector2f available) override
+		{
+			if (fixed_size_)
+			{
+				layout_dirty_ = false;
+				return size_;
+			}
+
+			if (layout_dirty_)
+			{
+				measure_cache_size_ = 0;
+				layout_dirty_ = false;
+			}
+
+			for (std::size_t i = 0; i < measure_cache_size_; i++)
+			{
+				if (measure_cache_[i].available == available)
+				{
+					return measure_cache_[i].size;
+				}
+			}
+
+			sf::Vector2f size = measureContent(available);
+
+			measure_cache_[measure_cache_next_] = { available, size };
+			measure_cache_next_ = (measure_cache_next_ + 1) % measure_cache_.size();
+			measure_cache_size_ = std::min(measure_cache_size_ + 1, measure_cache_.size());
+
+			return size;
+		}
+
+		void arrange(sf::Vector2f position, sf::Vector2f size) override
+		{
+			setPosition(position);
+
+			if (!fixed_size_ and size != size_)
+			{
+				requestRedraw();
+				size_ = size;
+				arrange_dirty_ = true;
+				requestRedraw();
+			}
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			if (position != position_)
+			{
+				Component::setPosition(position);
+				invalidateWorldTransform();
+			}
+		}
+
+		sf::FloatRect getBounds() const override
+		{
+			return getLocalTransform().transformRect(sf::FloatRect(0, 0, size_.x, size_.y));
+		}
+
+		const sf::Transform& getWorldTransform() const override
+		{
+			if (world_dirty_)
+			{
+				updateWorldTransform();
+			}
+			return world_;
+		}
+
+		const sf::Transform& getInverseWorldTransform() const override
+		{
+			if (world_dirty_)
+			{
+				updateWorldTransform();
+			}
+			return inverse_world_;
+		}
+
+		void invalidateWorldTransform() override
+		{
+			if (world_dirty_)
+			{
+				return;
+			}
+
+			world_dirty_ = true;
+			for (auto child : children_)
+			{
+				child->invalidateWorldTransform();
+			}
+		}
+
+		// Maps the container's child space to its parent's child space.
+		sf::Transform getLocalTransform() const
+		{
+			sf::Transform local;
+			local.translate(position_);
+			return local * transform_;
+		}
+
+		// Extra transform (rotation, scale) applied around the container's
+		// top-left corner, on top of its position.
+		void setTransform(const sf::Transform& transform)
+		{
+			requestRedraw();
+			transform_ = transform;
+			invalidateWorldTransform();
+			requestRedraw();
+		}
+
+		const sf::Transform& getTransform() const
+		{
+			return transform_;
+		}
+
+		// Renders the subtree into a pooled texture and draws it as one quad
+		// until a descendant requests a redraw. Meant for panels that rarely
+		// change; see RenderCache for the memory budget and hit counts.
+		void setCached(bool cached)
+		{
+			if (cached_ == cached)
+			{
+				return;
+			}
+
+			cached_ = cached;
+			cache_valid_ = false;
+			if (!cached_)
+			{
+				RenderCache::get().release(this, cache_slot_);
+			}
+			requestRedraw();
+		}
+
+		bool isCached() const
+		{
+			return cached_;
+		}
+
+		void addChild(Component* child)
+		{
+			tree_version_++;
+			child->parent_ = this;
+			child->invalidateWorldTransform();
+			children_.push_back(child);
+			childAdded(children_.size() - 1);
+			childRedrawRequested(child->getBounds());
+			childLayoutChanged();
+		}
+
+		// Gives ownership of the child back to the caller.
+		Component* removeChild(Component* child)
+		{
+			auto it = std::find(children_.begin(), children_.end(), child);
+			if (it == children_.end())
+			{
+				return nullptr;
+			}
+
+			childRedrawRequested(child->getBounds());
+
+			std::size_t index = it - children_.begin();
+			children_.erase(it);
+			childRemoved(index);
+			tree_version_++;
+			child->parent_ = nullptr;
+			child->invalidateWorldTransform();
+			childLayoutChanged();
+			return child;
+		}
+
+		const std::vector<Component*>& getChildren() const
+		{
+			return children_;
+		}
+
+		void setSize(sf::Vector2f size)
+		{
+			requestRedraw();
+			size_ = size;
+			fixed_size_ = true;
+			arrange_dirty_ = true;
+			layout_dirty_ = false;
+			invalidateLayout();
+		}
+
+		void setAutoSize()
+		{
+			fixed_size_ = false;
+			childLayoutChanged();
+		}
+
+		void setPadding(sf::Vector2f padding)
+		{
+			padding_ = padding;
+			childLayoutChanged();
+		}
+
+		void setSpacing(float spacing)
+		{
+			spacing_ = spacing;
+			childLayoutChanged();
+		}
+
+	};
+
+	class Box : public Container
+	{
+	private:
+
+		Orientation orientation_;
+		float cross_aligment_;
+
+	protected:
+
+		sf::Vector2f measureContent(sf::Vector2f available) override
+		{
+			float main = 0;
+			float cross = 0;
+
+			available = shrinkAvailable(available);
+			if (orientation_ == Orientation::Horizontal)
+			{
+				available.x = unconstrained.x;
+			}
+			else
+			{
+				available.y = unconstrained.y;
+			}
+
+			for (auto child : children_)
+			{
+				sf::Vector2f size = child->measure(available);
+				if (orientation_ == Orientation::Horizontal)
+				{
+					main += size.x;
+					cross = std::max(cross, size.y);
+				}
+				else
+				{
+					main += size.y;
+					cross = std::max(cross, size.x);
+				}
+			}
+
+			if (!children_.empty())
+			{
+				main += spacing_ * (children_.size() - 1);
+			}
+
+			sf::Vector2f size = orientation_ == Orientation::Horizontal ? sf::Vector2f(main, cross) : sf::Vector2f(cross, main);
+			return size + padding_ + padding_;
+		}
+
+		void arrangeContent() override
+		{
+			sf::Vector2f origin = contentOrigin();
+			sf::Vector2f available = contentSize();
+			float offset = 0;
+
+			sf::Vector2f constraint = available;
+			if (orientation_ == Orientation::Horizontal)
+			{
+				constraint.x = unconstrained.x;
+			}
+			else
+			{
+				constraint.y = unconstrained.y;
+			}
+
+			for (auto child : children_)
+			{
+				sf::Vector2f size = child->measure(constraint);
+				if (orientation_ == Orientation::Horizontal)
+				{
+					child->arrange({ origin.x + offset, origin.y + (available.y - size.y) * cross_aligment_ }, size);
+					offset += size.x + spacing_;
+				}
+				else
+				{
+					child->arrange({ origin.x + (available.x - size.x) * cross_aligment_, origin.y + offset }, size);
+					offset += size.y + spacing_;
+				}
+			}
+		}
+
+		Box(Orientation orientation, sf::RenderWindow* window) :
+			Container(window),
+			orientation_(orientation),
+			cross_aligment_(0)
+		{
+
+		}
+
+	public:
+
+		void setChildAligment(VerticalAligment aligment)
+		{
+			if (orientation_ == Orientation::Horizontal)
+			{
+				cross_aligment_ = aligment == VerticalAligment::Top ? 0.0f : aligment == VerticalAligment::Center ? 0.5f : 1.0f;
+				arrange_dirty_ = true;
+			}
+		}
+
+		void setChildAligment(HorizontalAligment aligment)
+		{
+			if (orientation_ == Orientation::Vertical)
+			{
+				cross_aligment_ = aligment == HorizontalAligment::Left ? 0.0f : aligment == HorizontalAligment::Center ? 0.5f : 1.0f;
+				arrange_dirty_ = true;
+			}
+		}
+
+	};
+
+	class HorizontalBox : public Box
+	{
+	public:
+
+		HorizontalBox(sf::RenderWindow* window) :
+			Box(Orientation::Horizontal, window)
+		{
+
+		}
+
+	};
+
+	class VerticalBox : public Box
+	{
+	public:
+
+		VerticalBox(sf::RenderWindow* window) :
+			Box(Orientation::Vertical, window)
+		{
+
+		}
+
+	};
+
+	class Grid : public Container
+	{
+	private:
+
+		std::size_t columns_;
+
+		std::vector<float> column_widths_;
+		std::vector<float> row_heights_;
+
+		std::vector<sf::Vector2f> cell_sizes_;
+
+		void measureCells()
+		{
+			std::size_t rows = (children_.size() + columns_ - 1) / columns_;
+			column_widths_.assign(columns_, 0.0f);
+			row_heights_.assign(rows, 0.0f);
+
+			cell_sizes_.resize(children_.size());
+
+			for (std::size_t i = 0; i < children_.size(); i++)
+			{
+				sf::Vector2f size = children_[i]->measure(unconstrained);
+				cell_sizes_[i] = size;
+				column_widths_[i % columns_] = std::max(column_widths_[i % columns_], size.x);
+				row_heights_[i / columns_] = std::max(row_heights_[i / columns_], size.y);
+			}
+		}
+
+	protected:
+
+		sf::Vector2f measureContent(sf::Vector2f) override
+		{
+			measureCells();
+
+			sf::Vector2f size(0, 0);
+			for (float width : column_widths_)
+			{
+				size.x += width;
+			}
+			for (float height : row_heights_)
+			{
+				size.y += height;
+			}
+
+			if (!column_widths_.empty())
+			{
+				size.x += spacing_ * (column_widths_.size() - 1);
+			}
+			if (!row_heights_.empty())
+			{
+				size.y += spacing_ * (row_heights_.size() - 1);
+			}
+
+			return size + padding_ + padding_;
+		}
+
+		void arrangeContent() override
+		{
+			// measureContent may have been answered from the cache
+			measureCells();
+
+			sf::Vector2f origin = contentOrigin();
+			sf::Vector2f offset(0, 0);
+
+			for (std::size_t i = 0; i < children_.size(); i++)
+			{
+				std::size_t column = i % columns_;
+				if (column == 0 and i != 0)
+				{
+					offset.x = 0;
+					offset.y += row_heights_[i / columns_ - 1] + spacing_;
+				}
+
+				children_[i]->arrange(origin + offset, cell_sizes_[i]);
+				offset.x += column_widths_[column] + spacing_;
+			}
+		}
+
+	public:
+
+		Grid(std::size_t columns, sf::RenderWindow* window) :
+			Container(window),
+			columns_(std::max<std::size_t>(columns, 1))
+		{
+
+		}
+
+		void setColumns(std::size_t columns)
+		{
+			columns_ = std::max<std::size_t>(columns, 1);
+			childLayoutChanged();
+		}
+
+	};
+
+	class Stack : public Container
+	{
+	private:
+
+		sf::Vector2f aligment_;
+
+	protected:
+
+		sf::Vector2f measureContent(sf::Vector2f available) override
+		{
+			available = shrinkAvailable(available);
+
+			sf::Vector2f size(0, 0);
+			for (auto child : children_)
+			{
+				sf::Vector2f child_size = child->measure(available);
+				size.x = std::max(size.x, child_size.x);
+				size.y = std::max(size.y, child_size.y);
+			}
+
+			return size + padding_ + padding_;
+		}
+
+		void arrangeContent() override
+		{
+			sf::Vector2f origin = contentOrigin();
+			sf::Vector2f available = contentSize();
+
+			for (auto child : children_)
+			{
+				sf::Vector2f size = child->measure(available);
+				child->arrange({ origin.x + (available.x - size.x) * aligment_.x, origin.y + (available.y - size.y) * aligment_.y }, size);
+			}
+		}
+
+	public:
+
+		Stack(sf::RenderWindow* window) :
+			Container(window),
+			aligment_({ 0, 0 })
+		{
+
+		}
+
+		void setChildAligment(HorizontalAligment aligment)
+		{
+			aligment_.x = aligment == HorizontalAligment::Left ? 0.0f : aligment == HorizontalAligment::Center ? 0.5f : 1.0f;
+			arrange_dirty_ = true;
+		}
+
+		void setChildAligment(VerticalAligment aligment)
+		{
+			aligment_.y = aligment == VerticalAligment::Top ? 0.0f : aligment == VerticalAligment::Center ? 0.5f : 1.0f;
+			arrange_dirty_ = true;
+		}
+
+	};
+
+	enum class FlexJustify
+	{
+		Start,
+		End,
+		Center,
+		SpaceBetween,
+		SpaceAround
+	};
+
+	enum class FlexAlign
+	{
+		Start,
+		End,
+		Center,
+		Stretch
+	};
+
+	struct FlexItem
+	{
+		float grow = 0;
+		float shrink = 1;
+		float basis = -1;
+		sf::Vector2f min_size = { 0, 0 };
+		sf::Vector2f max_size = unconstrained;
+	};
+
+	class FlexBox : public Container
+	{
+	private:
+
+		struct ItemLayout
+		{
+			float base;
+			float main;
+			float cross;
+			float violation;
+			bool frozen;
+		};
+
+		struct Line
+		{
+			std::size_t begin;
+			std::size_t end;
+			float main;
+			float cross;
+		};
+
+		Orientation direction_;
+		bool wrap_;
+		FlexJustify justify_;
+		FlexAlign align_items_;
+
+		std::vector<FlexItem> items_;
+
+		// scratch space reused between passes
+		std::vector<ItemLayout> layout_;
+		std::vector<Line> lines_;
+
+		float mainOf(sf::Vector2f vector) const
+		{
+			return direction_ == Orientation::Horizontal ? vector.x : vector.y;
+		}
+
+		float crossOf(sf::Vector2f vector) const
+		{
+			return direction_ == Orientation::Horizontal ? vector.y : vector.x;
+		}
+
+		sf::Vector2f makeVector(float main, float cross) const
+		{
+			return direction_ == Orientation::Horizontal ? sf::Vector2f(main, cross) : sf::Vector2f(cross, main);
+		}
+
+		void buildLines(float available_main, float available_cross)
+		{
+			layout_.resize(children_.size());
+			lines_.clear();
+
+			sf::Vector2f constraint = makeVector(unconstrained.x, available_cross);
+			Line line = { 0, 0, 0, 0 };
+
+			for (std::size_t i = 0; i < children_.size(); i++)
+			{
+				const FlexItem& item = items_[i];
+				sf::Vector2f measured = children_[i]->measure(constraint);
+
+				float base = item.basis >= 0 ? item.basis : mainOf(measured);
+				base = std::clamp(base, mainOf(item.min_size), std::max(mainOf(item.min_size), mainOf(item.max_size)));
+				float cross = std::clamp(crossOf(measured), crossOf(item.min_size), std::max(crossOf(item.min_size), crossOf(item.max_size)));
+				layout_[i] = { base, base, cross, 0, false };
+
+				float gap = line.end > line.begin ? spacing_ : 0;
+				if (wrap_ and line.end > line.begin and line.main + gap + base > available_main)
+				{
+					lines_.push_back(line);
+					line = { i, i, 0, 0 };
+					gap = 0;
+				}
+
+				line.main += gap + base;
+				line.cross = std::max(line.cross, cross);
+				line.end = i + 1;
+			}
+
+			if (line.end > line.begin)
+			{
+				lines_.push_back(line);
+			}
+		}
+
+		// Grows or shrinks the items of one line, freezing the ones that hit
+		// their min/max and redistributing the rest, as CSS flexbox does.
+		void resolveFlexibleLengths(Line& line, float available_main)
+		{
+			std::size_t count = line.end - line.begin;
+
+			for (std::size_t i = line.begin; i < line.end; i++)
+			{
+				layout_[i].main = layout_[i].base;
+				layout_[i].frozen = false;
+			}
+
+			for (std::size_t pass = 0; pass < count; pass++)
+			{
+				float used = spacing_ * (count - 1);
+				float grow = 0;
+				float shrink = 0;
+
+				for (std::size_t i = line.begin; i < line.end; i++)
+				{
+					if (layout_[i].frozen)
+					{
+						used += layout_[i].main;
+					}
+					else
+					{
+						used += layout_[i].base;
+						grow += items_[i].grow;
+						shrink += items_[i].shrink * layout_[i].base;
+					}
+				}
+
+				float free = available_main - used;
+				bool growing = free > 0;
+				if (free == 0 or (growing and grow <= 0) or (!growing and shrink <= 0))
+				{
+					break;
+				}
+
+				float violation = 0;
+				for (std::size_t i = line.begin; i < line.end; i++)
+				{
+					ItemLayout& layout = layout_[i];
+					if (layout.frozen)
+					{
+						continue;
+					}
+
+					float target = growing ? layout.base + free * items_[i].grow / grow : layout.base + free * items_[i].shrink * layout.base / shrink;
+					layout.main = std::clamp(target, mainOf(items_[i].min_size), std::max(mainOf(items_[i].min_size), mainOf(items_[i].max_size)));
+					layout.violation = layout.main - target;
+					violation += layout.violation;
+				}
+
+				if (violation == 0)
+				{
+					break;
+				}
+
+				for (std::size_t i = line.begin; i < line.end; i++)
+				{
+					ItemLayout& layout = layout_[i];
+					if (!layout.frozen and ((violation > 0 and layout.violation > 0) or (violation < 0 and layout.violation < 0)))
+					{
+						layout.frozen = true;
+					}
+				}
+			}
+
+			line.main = spacing_ * (count - 1);
+			for (std::size_t i = line.begin; i < line.end; i++)
+			{
+				line.main += layout_[i].main;
+			}
+		}
+
+	protected:
+
+		sf::Vector2f measureContent(sf::Vector2f available) override
+		{
+			available = shrinkAvailable(available);
+			buildLines(mainOf(available), crossOf(available));
+
+			float main = 0;
+			float cross = 0;
+			bool grows = false;
+
+			for (const Line& line : lines_)
+			{
+				main = std::max(main, line.main);
+				cross += line.cross;
+			}
+			if (!lines_.empty())
+			{
+				cross += spacing_ * (lines_.size() - 1);
+			}
+
+			for (const FlexItem& item : items_)
+			{
+				grows = grows or item.grow > 0;
+			}
+
+			// growing items claim all of the space they are offered
+			if (grows and mainOf(available) != mainOf(unconstrained))
+			{
+				main = std::max(main, mainOf(available));
+			}
+
+			return makeVector(main, cross) + padding_ + padding_;
+		}
+
+		void arrangeContent() override
+		{
+			sf::Vector2f origin = contentOrigin();
+			sf::Vector2f available = contentSize();
+			float available_main = mainOf(available);
+
+			buildLines(available_main, crossOf(available));
+
+			float cross_offset = 0;
+			for (Line& line : lines_)
+			{
+				resolveFlexibleLengths(line, available_main);
+
+				std::size_t count = line.end - line.begin;
+				float free = std::max(available_main - line.main, 0.0f);
+				float offset = 0;
+				float gap = spacing_;
+
+				switch (justify_)
+				{
+				case FlexJustify::Start:
+					break;
+
+				case FlexJustify::End:
+					offset = free;
+					break;
+
+				case FlexJustify::Center:
+					offset = free / 2;
+					break;
+
+				case FlexJustify::SpaceBetween:
+					gap += count > 1 ? free / (count - 1) : 0;
+					break;
+
+				case FlexJustify::SpaceAround:
+					offset = free / count / 2;
+					gap += free / count;
+					break;
+				}
+
+				float line_cross = lines_.size() == 1 and !wrap_ ? crossOf(available) : line.cross;
+
+				for (std::size_t i = line.begin; i < line.end; i++)
+				{
+					const FlexItem& item = items_[i];
+					float cross = layout_[i].cross;
+					float cross_position = 0;
+
+					switch (align_items_)
+					{
+					case FlexAlign::Start:
+						break;
+
+					case FlexAlign::End:
+						cross_position = line_cross - cross;
+						break;
+
+					case FlexAlign::Center:
+						cross_position = (line_cross - cross) / 2;
+						break;
+
+					case FlexAlign::Stretch:
+						cross = std::clamp(line_cross, crossOf(item.min_size), std::max(crossOf(item.min_size), crossOf(item.max_size)));
+						break;
+					}
+
+					children_[i]->arrange(origin + makeVector(offset, cross_offset + cross_position), makeVector(layout_[i].main, cross));
+					offset += layout_[i].main + gap;
+				}
+
+				cross_offset += line_cross + spacing_;
+			}
+		}
+
+		void childAdded(std::size_t index) override
+		{
+			items_.insert(items_.begin() + index, FlexItem());
+		}
+
+		void childRemoved(std::size_t index) override
+		{
+			items_.erase(items_.begin() + index);
+		}
+
+	public:
+
+		FlexBox(Orientation direction, sf::RenderWindow* window) :
+			Container(window),
+			direction_(direction),
+			wrap_(false),
+			justify_(FlexJustify::Start),
+			align_items_(FlexAlign::Start)
+		{
+
+		}
+
+		using Container::addChild;
+
+		void addChild(Component* child, FlexItem item)
+		{
+			Container::addChild(child);
+			items_.back() = item;
+		}
+
+		void setFlex(Component* child, FlexItem item)
+		{
+			auto it = std::find(children_.begin(), children_.end(), child);
+			if (it != children_.end())
+			{
+				items_[it - children_.begin()] = item;
+				childLayoutChanged();
+			}
+		}
+
+		void setDirection(Orientation direction)
+		{
+			direction_ = direction;
+			childLayoutChanged();
+		}
+
+		void setWrap(bool wrap)
+		{
+			wrap_ = wrap;
+			childLayoutChanged();
+		}
+
+		void setJustify(FlexJustify justify)
+		{
+			justify_ = justify;
+			arrange_dirty_ = true;
+		}
+
+		void setAlignItems(FlexAlign align)
+		{
+			align_items_ = align;
+			arrange_dirty_ = true;
+		}
+
+	};
+}
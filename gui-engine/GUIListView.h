@@ -0,0 +1,334 @@
+#pragma once
+
+#include "GUICore.h"
+#include <vector>
+#include <cmath>
+
+namespace gui
+{
+	class IListDataSource
+	{
+	protected:
+
+		IListDataSource()
+		{
+
+		}
+
+	public:
+
+		virtual std::size_t getItemCount() const = 0;
+
+		// The returned text only has to stay valid until the next call.
+		virtual std::string_view getItemText(std::size_t index) = 0;
+
+	};
+
+	class ListView : public Component, public IAssetListener
+	{
+	private:
+
+		static constexpr std::size_t unbound = static_cast<std::size_t>(-1);
+
+		struct Row
+		{
+			sf::Text text;
+			sf::String string;
+			std::size_t index;
+		};
+
+		IListDataSource* source_;
+		AssetLoader::Font font_;
+
+		// item i is always shown by rows_[i % rows_.size()], so scrolling by one
+		// row rebinds exactly one pooled row
+		mutable std::vector<Row> rows_;
+
+		float row_height_;
+		unsigned int font_size_;
+		double scroll_offset_;
+
+		mutable std::size_t selected_;
+
+		sf::RectangleShape background_;
+		mutable sf::RectangleShape selection_;
+
+		sf::Color text_color_;
+
+		void InitRows()
+		{
+			std::size_t count = static_cast<std::size_t>(std::ceil(size_.y / row_height_)) + 1;
+
+			rows_.resize(count);
+			for (auto& row : rows_)
+			{
+				if (font_->ready)
+				{
+					row.text.setFont(font_->font);
+				}
+				row.text.setCharacterSize(font_size_);
+				row.text.setFillColor(text_color_);
+				row.index = unbound;
+			}
+		}
+
+		std::size_t firstVisible() const
+		{
+			return static_cast<std::size_t>(scroll_offset_ / row_height_);
+		}
+
+		double maxScrollOffset() const
+		{
+			std::size_t count = source_ != nullptr ? source_->getItemCount() : 0;
+			return std::max(0.0, count * static_cast<double>(row_height_) - size_.y);
+		}
+
+		void bindRows() const
+		{
+			std::size_t count = source_->getItemCount();
+			std::size_t first = firstVisible();
+			std::size_t last = std::min(first + rows_.size(), count);
+
+			for (std::size_t i = first; i < last; i++)
+			{
+				Row& row = rows_[i % rows_.size()];
+				if (row.index != i)
+				{
+					utf8::decode(source_->getItemText(i), row.string);
+					row.text.setString(row.string);
+					row.index = i;
+				}
+
+				// double keeps the offset exact far down a 10M-row list
+				float y = static_cast<float>(i * static_cast<double>(row_height_) - scroll_offset_);
+				row.text.setPosition(position_.x + 4, position_.y + y);
+			}
+		}
+
+		void assetReady() override
+		{
+			for (auto& row : rows_)
+			{
+				row.text.setFont(font_->font);
+			}
+			requestRedraw();
+		}
+
+		// Up and Down move the selection; past either end focus moves on.
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			if (source_ == nullptr or source_->getItemCount() == 0 or (key.code != sf::Keyboard::Up and key.code != sf::Keyboard::Down))
+			{
+				return false;
+			}
+
+			std::size_t index;
+			if (selected_ == unbound)
+			{
+				index = 0;
+			}
+			else if (key.code == sf::Keyboard::Up)
+			{
+				if (selected_ == 0)
+				{
+					return false;
+				}
+				index = selected_ - 1;
+			}
+			else
+			{
+				if (selected_ + 1 >= source_->getItemCount())
+				{
+					return false;
+				}
+				index = selected_ + 1;
+			}
+
+			selected_ = index;
+			scrollToItem(index);
+			requestRedraw();
+			return true;
+		}
+
+		void pointerEvent(PointerEvent& event) override
+		{
+			if (event.type == PointerEventType::Wheel)
+			{
+				// at either end the wheel goes on to the enclosing scroll view
+				double offset = scroll_offset_;
+				scrollBy(-event.delta.y * wheel_step);
+				if (scroll_offset_ != offset)
+				{
+					event.stopPropagation();
+				}
+			}
+			else if (event.type == PointerEventType::Click and source_ != nullptr)
+			{
+				// selected before click() tells the listeners
+				std::size_t index = static_cast<std::size_t>((event.position.y - position_.y + scroll_offset_) / row_height_);
+				if (index < source_->getItemCount())
+				{
+					selected_ = index;
+					requestRedraw();
+				}
+			}
+		}
+
+	public:
+
+		ListView(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			Component(position, size, window),
+			source_(nullptr),
+			row_height_(30),
+			font_size_(20),
+			scroll_offset_(0),
+			selected_(unbound),
+			text_color_(sf::Color::White)
+		{
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
+
+			background_.setPosition(position_);
+			background_.setSize(size_);
+			background_.setFillColor(sf::Color(30, 30, 30));
+
+			selection_.setFillColor(sf::Color(60, 90, 160));
+
+			InitRows();
+			font_->addListener(this);
+			subscribe(PointerCategory::Button | PointerCategory::Wheel);
+			setFocusable(true);
+		}
+
+		~ListView() override
+		{
+			font_->removeListener(this);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			if (!visibility or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			Component::update();
+
+			sf::View previous = target.getView();
+			target.setView(clipView(target, animation_state.transform.transformRect(getBounds())));
+			target.draw(background_, animation_state);
+
+			if (source_ != nullptr)
+			{
+				bindRows();
+
+				std::size_t first = firstVisible();
+				std::size_t last = std::min(first + rows_.size(), source_->getItemCount());
+
+				if (selected_ >= first and selected_ < last)
+				{
+					float y = static_cast<float>(selected_ * static_cast<double>(row_height_) - scroll_offset_);
+					selection_.setPosition(position_.x, position_.y + y);
+					selection_.setSize({ size_.x, row_height_ });
+					target.draw(selection_, animation_state);
+				}
+
+				for (std::size_t i = first; i < last; i++)
+				{
+					target.draw(rows_[i % rows_.size()].text, animation_state);
+				}
+			}
+
+			drawFocus(target, animation_state);
+			target.setView(previous);
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			Component::setPosition(position);
+			background_.setPosition(position_);
+		}
+
+		void setDataSource(IListDataSource* source)
+		{
+			source_ = source;
+			scroll_offset_ = 0;
+			selected_ = unbound;
+			refresh();
+		}
+
+		// Call after the items behind the data source changed.
+		void refresh()
+		{
+			for (auto& row : rows_)
+			{
+				row.index = unbound;
+			}
+			scroll_offset_ = std::min(scroll_offset_, maxScrollOffset());
+			requestRedraw();
+		}
+
+		void scrollBy(float pixels)
+		{
+			setScrollOffset(scroll_offset_ + pixels);
+		}
+
+		void setScrollOffset(double offset)
+		{
+			offset = std::clamp(offset, 0.0, maxScrollOffset());
+			if (offset != scroll_offset_)
+			{
+				scroll_offset_ = offset;
+				requestRedraw();
+			}
+		}
+
+		double getScrollOffset() const
+		{
+			return scroll_offset_;
+		}
+
+		void scrollToItem(std::size_t index)
+		{
+			double top = index * static_cast<double>(row_height_);
+			if (top < scroll_offset_)
+			{
+				setScrollOffset(top);
+			}
+			else if (top + row_height_ > scroll_offset_ + size_.y)
+			{
+				setScrollOffset(top + row_height_ - size_.y);
+			}
+		}
+
+		std::size_t getSelectedItem() const
+		{
+			return selected_;
+		}
+
+		void setRowHeight(float height)
+		{
+			row_height_ = height;
+			InitRows();
+			setScrollOffset(scroll_offset_);
+		}
+
+		void setFontSize(unsigned int size)
+		{
+			font_size_ = size;
+			InitRows();
+			requestRedraw();
+		}
+
+		void setColor(sf::Color background, sf::Color text)
+		{
+			background_.setFillColor(background);
+			text_color_ = text;
+			for (auto& row : rows_)
+			{
+				row.text.setFillColor(text_color_);
+			}
+			requestRedraw();
+		}
+
+	};
+}
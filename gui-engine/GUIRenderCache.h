@@ -0,0 +1,212 @@
+#pragma once
+
+#include "GUICore.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace gui
+{
+	// Pool of render textures that cached containers draw their subtree into.
+	// Textures count against a byte budget; when it is exceeded the least
+	// recently drawn caches are dropped and re-rendered on their next draw.
+	class RenderCache
+	{
+	public:
+
+		struct Stats
+		{
+			std::size_t hits = 0;
+			std::size_t renders = 0;
+			std::size_t evictions = 0;
+			std::size_t resident_bytes = 0;
+		};
+
+	private:
+
+		struct Entry
+		{
+			std::unique_ptr<sf::RenderTexture> texture;
+			sf::Vector2u size;
+			const void* owner;
+			std::uint64_t last_used;
+		};
+
+		std::vector<Entry> entries_;
+		std::size_t budget_;
+		std::uint64_t clock_;
+		Stats stats_;
+
+		RenderCache() :
+			budget_(64 * 1024 * 1024),
+			clock_(0)
+		{
+
+		}
+
+		static std::size_t bytes(sf::Vector2u size)
+		{
+			return static_cast<std::size_t>(size.x) * size.y * 4;
+		}
+
+		void free(Entry& entry)
+		{
+			if (entry.texture != nullptr)
+			{
+				stats_.resident_bytes -= bytes(entry.size);
+				entry.texture.reset();
+			}
+			entry.owner = nullptr;
+		}
+
+		void evict(std::size_t keep)
+		{
+			while (stats_.resident_bytes > budget_)
+			{
+				std::size_t oldest = entries_.size();
+				for (std::size_t i = 0; i < entries_.size(); i++)
+				{
+					if (i != keep and entries_[i].texture != nullptr and (oldest == entries_.size() or entries_[i].last_used < entries_[oldest].last_used))
+					{
+						oldest = i;
+					}
+				}
+
+				if (oldest == entries_.size())
+				{
+					// a single cache larger than the budget is still allowed
+					return;
+				}
+
+				if (entries_[oldest].owner != nullptr)
+				{
+					stats_.evictions++;
+				}
+				free(entries_[oldest]);
+			}
+		}
+
+	public:
+
+		static RenderCache& get()
+		{
+			static RenderCache cache;
+			return cache;
+		}
+
+		// Returns the owner's texture, sized `size`. `slot` is the owner's
+		// handle into the pool; `fresh` is set when the texture's contents
+		// are not the owner's last rendering and it has to draw again.
+		sf::RenderTexture* acquire(const void* owner, std::size_t& slot, sf::Vector2u size, bool& fresh)
+		{
+			clock_++;
+
+			if (slot < entries_.size() and entries_[slot].owner == owner and entries_[slot].size == size)
+			{
+				entries_[slot].last_used = clock_;
+				fresh = false;
+				return entries_[slot].texture.get();
+			}
+
+			release(owner, slot);
+			fresh = true;
+
+			// prefer an unowned texture of the same size, then an empty slot
+			std::size_t found = entries_.size();
+			for (std::size_t i = 0; i < entries_.size(); i++)
+			{
+				if (entries_[i].owner == nullptr)
+				{
+					if (entries_[i].texture != nullptr and entries_[i].size == size)
+					{
+						found = i;
+						break;
+					}
+					if (found == entries_.size() and entries_[i].texture == nullptr)
+					{
+						found = i;
+					}
+				}
+			}
+
+			if (found == entries_.size())
+			{
+				entries_.push_back({ nullptr, { 0, 0 }, nullptr, 0 });
+			}
+
+			Entry& entry = entries_[found];
+			if (entry.texture == nullptr)
+			{
+				entry.texture = std::make_unique<sf::RenderTexture>();
+				if (!entry.texture->create(size.x, size.y))
+				{
+					entry.texture.reset();
+					return nullptr;
+				}
+				entry.size = size;
+				stats_.resident_bytes += bytes(size);
+			}
+
+			entry.owner = owner;
+			entry.last_used = clock_;
+			slot = found;
+
+			evict(found);
+			return entry.texture.get();
+		}
+
+		// Returns the owner's texture to the pool for reuse by another cache.
+		void release(const void* owner, std::size_t& slot)
+		{
+			if (slot < entries_.size() and entries_[slot].owner == owner)
+			{
+				entries_[slot].owner = nullptr;
+			}
+			slot = static_cast<std::size_t>(-1);
+		}
+
+		void setBudget(std::size_t bytes)
+		{
+			budget_ = bytes;
+			evict(entries_.size());
+		}
+
+		std::size_t getBudget() const
+		{
+			return budget_;
+		}
+
+		void countHit()
+		{
+			stats_.hits++;
+		}
+
+		void countRender()
+		{
+			stats_.renders++;
+		}
+
+		const Stats& getStats() const
+		{
+			return stats_;
+		}
+
+		void resetStats()
+		{
+			std::size_t resident = stats_.resident_bytes;
+			stats_ = Stats();
+			stats_.resident_bytes = resident;
+		}
+
+		// Drops every texture, e.g. before the GL context goes away.
+		void clear()
+		{
+			for (auto& entry : entries_)
+			{
+				free(entry);
+			}
+			entries_.clear();
+		}
+
+	};
+}
@@ -0,0 +1,649 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace gui
+{
+	// Read-only view of a whole file through the OS page cache.
+	class MappedFile
+	{
+	private:
+
+		const std::uint8_t* data_;
+		std::size_t size_;
+
+#ifdef _WIN32
+		HANDLE file_;
+		HANDLE mapping_;
+#endif
+
+	public:
+
+		MappedFile() :
+			data_(nullptr),
+			size_(0)
+#ifdef _WIN32
+			, file_(INVALID_HANDLE_VALUE),
+			mapping_(nullptr)
+#endif
+		{
+
+		}
+
+		~MappedFile()
+		{
+			close();
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& path)
+		{
+			close();
+
+#ifdef _WIN32
+			file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file_, &size) or size.QuadPart == 0)
+			{
+				close();
+				return false;
+			}
+
+			mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			void* data = mapping_ != nullptr ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+			if (data == nullptr)
+			{
+				close();
+				return false;
+			}
+
+			data_ = static_cast<const std::uint8_t*>(data);
+			size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+			int file = ::open(path.c_str(), O_RDONLY);
+			if (file < 0)
+			{
+				return false;
+			}
+
+			struct stat info;
+			if (fstat(file, &info) != 0 or info.st_size == 0)
+			{
+				::close(file);
+				return false;
+			}
+
+			// the mapping keeps the file alive, the descriptor is not needed
+			void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			::close(file);
+			if (data == MAP_FAILED)
+			{
+				return false;
+			}
+
+			data_ = static_cast<const std::uint8_t*>(data);
+			size_ = static_cast<std::size_t>(info.st_size);
+#endif
+			return true;
+		}
+
+		void close()
+		{
+#ifdef _WIN32
+			if (data_ != nullptr)
+			{
+				UnmapViewOfFile(data_);
+			}
+			if (mapping_ != nullptr)
+			{
+				CloseHandle(mapping_);
+				mapping_ = nullptr;
+			}
+			if (file_ != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file_);
+				file_ = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (data_ != nullptr)
+			{
+				munmap(const_cast<std::uint8_t*>(data_), size_);
+			}
+#endif
+			data_ = nullptr;
+			size_ = 0;
+		}
+
+		const std::uint8_t* data() const
+		{
+			return data_;
+		}
+
+		std::size_t size() const
+		{
+			return size_;
+		}
+
+	};
+
+	// Read-only access to a file larger than the address space can take,
+	// through a few fixed-size windows mapped on demand. The least recently
+	// used window is unmapped when another one is needed.
+	class PagedFile
+	{
+	public:
+
+		// a multiple of the 64 KB Windows mapping granularity and of any page size
+		static constexpr std::uint64_t page_size = 1 << 20;
+		static constexpr std::size_t max_pages = 8;
+
+	private:
+
+		struct Page
+		{
+			std::uint64_t index;
+			const std::uint8_t* data;
+			std::size_t size;
+			std::uint64_t used;
+		};
+
+		std::vector<Page> pages_;
+		std::uint64_t size_;
+		std::uint64_t clock_;
+
+#ifdef _WIN32
+		HANDLE file_;
+		HANDLE mapping_;
+#else
+		int file_;
+#endif
+
+		void unmap(const Page& page)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(page.data);
+#else
+			munmap(const_cast<std::uint8_t*>(page.data), page.size);
+#endif
+		}
+
+		const Page* map(std::uint64_t index)
+		{
+			for (auto& page : pages_)
+			{
+				if (page.index == index)
+				{
+					page.used = ++clock_;
+					return &page;
+				}
+			}
+
+			std::uint64_t offset = index * page_size;
+			std::size_t size = static_cast<std::size_t>(std::min(page_size, size_ - offset));
+
+#ifdef _WIN32
+			void* data = MapViewOfFile(mapping_, FILE_MAP_READ, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), size);
+			if (data == nullptr)
+			{
+				return nullptr;
+			}
+#else
+			void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_, static_cast<off_t>(offset));
+			if (data == MAP_FAILED)
+			{
+				return nullptr;
+			}
+#endif
+
+			if (pages_.size() == max_pages)
+			{
+				auto oldest = std::min_element(pages_.begin(), pages_.end(), [](const Page& a, const Page& b)
+				{
+					return a.used < b.used;
+				});
+				unmap(*oldest);
+				pages_.erase(oldest);
+			}
+
+			pages_.push_back({ index, static_cast<const std::uint8_t*>(data), size, ++clock_ });
+			return &pages_.back();
+		}
+
+	public:
+
+		PagedFile() :
+			size_(0),
+			clock_(0)
+#ifdef _WIN32
+			, file_(INVALID_HANDLE_VALUE),
+			mapping_(nullptr)
+#else
+			, file_(-1)
+#endif
+		{
+
+		}
+
+		~PagedFile()
+		{
+			close();
+		}
+
+		PagedFile(const PagedFile&) = delete;
+		PagedFile& operator=(const PagedFile&) = delete;
+
+		// Nothing is mapped until read() asks for it.
+		bool open(const std::string& path)
+		{
+			close();
+
+#ifdef _WIN32
+			file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file_ == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file_, &size) or size.QuadPart == 0)
+			{
+				close();
+				return false;
+			}
+
+			mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping_ == nullptr)
+			{
+				close();
+				return false;
+			}
+			size_ = static_cast<std::uint64_t>(size.QuadPart);
+#else
+			file_ = ::open(path.c_str(), O_RDONLY);
+			if (file_ < 0)
+			{
+				return false;
+			}
+
+			struct stat info;
+			if (fstat(file_, &info) != 0 or info.st_size == 0)
+			{
+				close();
+				return false;
+			}
+			size_ = static_cast<std::uint64_t>(info.st_size);
+#endif
+			return true;
+		}
+
+		void close()
+		{
+			for (const auto& page : pages_)
+			{
+				unmap(page);
+			}
+			pages_.clear();
+
+#ifdef _WIN32
+			if (mapping_ != nullptr)
+			{
+				CloseHandle(mapping_);
+				mapping_ = nullptr;
+			}
+			if (file_ != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(file_);
+				file_ = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (file_ >= 0)
+			{
+				::close(file_);
+				file_ = -1;
+			}
+#endif
+			size_ = 0;
+		}
+
+		// The bytes from `offset` to the end of its page, which stay valid
+		// until max_pages other pages have been read. Returns nullptr past
+		// the end of the file or if the page cannot be mapped.
+		const std::uint8_t* read(std::uint64_t offset, std::size_t& available)
+		{
+			available = 0;
+			if (offset >= size_)
+			{
+				return nullptr;
+			}
+
+			const Page* page = map(offset / page_size);
+			if (page == nullptr)
+			{
+				return nullptr;
+			}
+
+			std::size_t start = static_cast<std::size_t>(offset % page_size);
+			available = page->size - start;
+			return page->data + start;
+		}
+
+		std::uint64_t size() const
+		{
+			return size_;
+		}
+
+		bool isOpen() const
+		{
+			return size_ > 0;
+		}
+
+	};
+
+	// All assets in one file, opened once and mapped instead of read:
+	//
+	//     header   "GUIPACK1", u32 version, u32 entry count, u64 index offset
+	//     payloads each starting on a pack_alignment boundary
+	//     index    per entry: u64 offset, u64 size, u32 type, u32 width,
+	//              u32 height, u32 name length, name bytes
+	//
+	// Integers are little-endian. Images can be stored pre-decoded as RGBA,
+	// which uploads straight from the mapping without any PNG inflation.
+	class ResourcePack
+	{
+	public:
+
+		enum class Type : std::uint32_t
+		{
+			// file bytes as they were, e.g. a TTF or a PNG
+			Raw = 0,
+			// width * height RGBA pixels
+			Rgba = 1
+		};
+
+		struct Entry
+		{
+			std::string_view name;
+			Type type;
+			unsigned int width;
+			unsigned int height;
+			const std::uint8_t* data;
+			std::size_t size;
+		};
+
+		static constexpr char magic[8] = { 'G', 'U', 'I', 'P', 'A', 'C', 'K', '1' };
+		static constexpr std::uint32_t version = 1;
+		static constexpr std::size_t header_size = 24;
+		// an index record without its name
+		static constexpr std::size_t record_size = 32;
+		static constexpr std::size_t pack_alignment = 16;
+
+	private:
+
+		MappedFile file_;
+		std::vector<Entry> entries_;
+		std::unordered_map<std::string_view, std::size_t> index_;
+
+		template <typename T>
+		static bool read(const std::uint8_t*& it, const std::uint8_t* end, T& value)
+		{
+			if (static_cast<std::size_t>(end - it) < sizeof(T))
+			{
+				return false;
+			}
+			std::memcpy(&value, it, sizeof(T));
+			it += sizeof(T);
+			return true;
+		}
+
+	public:
+
+		ResourcePack()
+		{
+
+		}
+
+		// Maps the pack and reads its index; the payloads are only touched
+		// when an asset is loaded.
+		bool open(const std::string& path)
+		{
+			entries_.clear();
+			index_.clear();
+
+			if (!file_.open(path) or file_.size() < header_size or std::memcmp(file_.data(), magic, sizeof(magic)) != 0)
+			{
+				file_.close();
+				return false;
+			}
+
+			const std::uint8_t* begin = file_.data();
+			const std::uint8_t* end = begin + file_.size();
+			const std::uint8_t* it = begin + sizeof(magic);
+
+			std::uint32_t file_version;
+			std::uint32_t count;
+			std::uint64_t index_offset;
+			read(it, end, file_version);
+			read(it, end, count);
+			read(it, end, index_offset);
+
+			// the count is checked against the index size before anything is
+			// reserved for it
+			if (file_version != version or index_offset > file_.size() or count > (file_.size() - index_offset) / record_size)
+			{
+				file_.close();
+				return false;
+			}
+
+			entries_.reserve(count);
+			it = begin + index_offset;
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				std::uint64_t offset;
+				std::uint64_t size;
+				std::uint32_t type;
+				std::uint32_t width;
+				std::uint32_t height;
+				std::uint32_t name_length;
+
+				if (!read(it, end, offset) or !read(it, end, size) or !read(it, end, type) or !read(it, end, width) or !read(it, end, height) or !read(it, end, name_length)
+					or static_cast<std::size_t>(end - it) < name_length or offset > file_.size() or size > file_.size() - offset
+					// raw pixels are read as width * height * 4 bytes without another check
+					or (type == static_cast<std::uint32_t>(Type::Rgba) and std::uint64_t(width) * height * 4 != size))
+				{
+					entries_.clear();
+					index_.clear();
+					file_.close();
+					return false;
+				}
+
+				std::string_view name(reinterpret_cast<const char*>(it), name_length);
+				it += name_length;
+
+				index_[name] = entries_.size();
+				entries_.push_back({ name, static_cast<Type>(type), width, height, begin + offset, static_cast<std::size_t>(size) });
+			}
+
+			return true;
+		}
+
+		bool isOpen() const
+		{
+			return file_.data() != nullptr;
+		}
+
+		const Entry* find(std::string_view name) const
+		{
+			auto it = index_.find(name);
+			return it != index_.end() ? &entries_[it->second] : nullptr;
+		}
+
+		const std::vector<Entry>& getEntries() const
+		{
+			return entries_;
+		}
+
+		// The font reads its glyphs from the mapping, so the pack has to
+		// outlive it.
+		bool loadFont(std::string_view name, sf::Font& font) const
+		{
+			const Entry* entry = find(name);
+			return entry != nullptr and font.loadFromMemory(entry->data, entry->size);
+		}
+
+		bool loadImage(std::string_view name, sf::Image& image) const
+		{
+			const Entry* entry = find(name);
+			if (entry == nullptr)
+			{
+				return false;
+			}
+
+			if (entry->type == Type::Rgba)
+			{
+				image.create(entry->width, entry->height, entry->data);
+				return true;
+			}
+			return image.loadFromMemory(entry->data, entry->size);
+		}
+
+		// Pre-decoded images go to the GPU straight from the mapped pages.
+		bool loadTexture(std::string_view name, sf::Texture& texture) const
+		{
+			const Entry* entry = find(name);
+			if (entry == nullptr)
+			{
+				return false;
+			}
+
+			if (entry->type == Type::Rgba)
+			{
+				if (!texture.create(entry->width, entry->height))
+				{
+					return false;
+				}
+				texture.update(entry->data);
+				return true;
+			}
+			return texture.loadFromMemory(entry->data, entry->size);
+		}
+
+	};
+
+	// Builds a pack file; used by tools/PackResources.cpp.
+	class ResourcePackWriter
+	{
+	private:
+
+		struct Item
+		{
+			std::string name;
+			ResourcePack::Type type;
+			unsigned int width;
+			unsigned int height;
+			std::vector<std::uint8_t> data;
+		};
+
+		std::vector<Item> items_;
+
+		template <typename T>
+		static void write(std::ofstream& out, T value)
+		{
+			out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		static void pad(std::ofstream& out, std::uint64_t& offset)
+		{
+			static const char zeros[ResourcePack::pack_alignment] = {};
+			std::uint64_t padding = (ResourcePack::pack_alignment - offset % ResourcePack::pack_alignment) % ResourcePack::pack_alignment;
+			out.write(zeros, static_cast<std::streamsize>(padding));
+			offset += padding;
+		}
+
+	public:
+
+		void addRaw(const std::string& name, std::vector<std::uint8_t> data)
+		{
+			items_.push_back({ name, ResourcePack::Type::Raw, 0, 0, std::move(data) });
+		}
+
+		void addImage(const std::string& name, const sf::Image& image)
+		{
+			const std::uint8_t* pixels = image.getPixelsPtr();
+			std::size_t size = static_cast<std::size_t>(image.getSize().x) * image.getSize().y * 4;
+			items_.push_back({ name, ResourcePack::Type::Rgba, image.getSize().x, image.getSize().y, std::vector<std::uint8_t>(pixels, pixels + size) });
+		}
+
+		bool save(const std::string& path) const
+		{
+			std::ofstream out(path, std::ios::binary);
+			if (!out)
+			{
+				return false;
+			}
+
+			out.write(ResourcePack::magic, sizeof(ResourcePack::magic));
+			write(out, ResourcePack::version);
+			write(out, static_cast<std::uint32_t>(items_.size()));
+			write(out, std::uint64_t(0));
+
+			std::uint64_t offset = ResourcePack::header_size;
+			std::vector<std::uint64_t> offsets;
+			for (const auto& item : items_)
+			{
+				pad(out, offset);
+				offsets.push_back(offset);
+				out.write(reinterpret_cast<const char*>(item.data.data()), static_cast<std::streamsize>(item.data.size()));
+				offset += item.data.size();
+			}
+
+			pad(out, offset);
+			std::uint64_t index_offset = offset;
+			for (std::size_t i = 0; i < items_.size(); i++)
+			{
+				const Item& item = items_[i];
+				write(out, offsets[i]);
+				write(out, static_cast<std::uint64_t>(item.data.size()));
+				write(out, static_cast<std::uint32_t>(item.type));
+				write(out, static_cast<std::uint32_t>(item.width));
+				write(out, static_cast<std::uint32_t>(item.height));
+				write(out, static_cast<std::uint32_t>(item.name.size()));
+				out.write(item.name.data(), static_cast<std::streamsize>(item.name.size()));
+			}
+
+			out.seekp(sizeof(ResourcePack::magic) + 8);
+			write(out, index_offset);
+			return static_cast<bool>(out);
+		}
+
+	};
+}
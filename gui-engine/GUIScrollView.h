@@ -0,0 +1,369 @@
+#pragma once
+
+#include "GUILayout.h"
+#include <cmath>
+
+namespace gui
+{
+	// Shows a window onto a larger content component. The content is rendered
+	// into a texture once; scrolling shifts the rendered pixels and only draws
+	// the strip that scrolled into view, and child changes only redraw the
+	// area they report through requestRedraw().
+	class ScrollView : public Container
+	{
+	private:
+
+		sf::RenderTexture textures_[2];
+		int front_;
+
+		sf::Vector2f scroll_;
+		sf::Vector2f rendered_scroll_;
+
+		bool valid_;
+		bool has_dirty_;
+		sf::FloatRect dirty_;
+
+		sf::Color background_;
+
+		mutable sf::Sprite sprite_;
+
+		Component* content() const
+		{
+			return children_.empty() ? nullptr : children_.front();
+		}
+
+		sf::FloatRect visibleArea() const
+		{
+			return sf::FloatRect(scroll_, size_);
+		}
+
+		sf::Vector2f maxScroll() const
+		{
+			sf::Vector2f content_size = content() != nullptr ? content()->getSize() : sf::Vector2f(0, 0);
+			return { std::max(content_size.x - size_.x, 0.0f), std::max(content_size.y - size_.y, 0.0f) };
+		}
+
+		// Keeps the components inside the viewport pickable, also when their
+		// pixels come from the texture; nested scroll views handle their own
+		// content.
+		void updateVisible(const Component* component) const
+		{
+			if (!component->visibility or !overlaps(visibleArea(), component->getParent()->getWorldTransform().transformRect(component->getBounds())))
+			{
+				return;
+			}
+
+			if (auto scroll_view = dynamic_cast<const ScrollView*>(component))
+			{
+				scroll_view->updateContent();
+			}
+			else if (auto container = dynamic_cast<const Container*>(component))
+			{
+				for (auto child : container->getChildren())
+				{
+					updateVisible(child);
+				}
+			}
+			else
+			{
+				updateChild(component);
+			}
+		}
+
+		void updateContent() const
+		{
+			if (content() != nullptr)
+			{
+				updateVisible(content());
+			}
+		}
+
+		// Draws the content behind `region`, given in viewport pixels.
+		void renderRegion(sf::RenderTexture& texture, sf::FloatRect region)
+		{
+			sf::FloatRect area(scroll_.x + region.left, scroll_.y + region.top, region.width, region.height);
+
+			sf::View view(area);
+			view.setViewport(sf::FloatRect(region.left / size_.x, region.top / size_.y, region.width / size_.x, region.height / size_.y));
+			texture.setView(view);
+
+			sf::RectangleShape background(sf::Vector2f(area.width, area.height));
+			background.setPosition(area.left, area.top);
+			background.setFillColor(background_);
+			texture.draw(background, sf::BlendNone);
+
+			if (content() != nullptr)
+			{
+				texture.draw(*content());
+			}
+
+			texture.setView(texture.getDefaultView());
+		}
+
+		void render()
+		{
+			sf::Vector2u size(static_cast<unsigned int>(size_.x), static_cast<unsigned int>(size_.y));
+			if (size.x == 0 or size.y == 0)
+			{
+				return;
+			}
+
+			if (textures_[front_].getSize() != size)
+			{
+				textures_[0].create(size.x, size.y);
+				textures_[1].create(size.x, size.y);
+				valid_ = false;
+			}
+
+			sf::Vector2f delta = scroll_ - rendered_scroll_;
+			sf::FloatRect viewport(0, 0, size_.x, size_.y);
+
+			if (!valid_ or std::abs(delta.x) >= size_.x or std::abs(delta.y) >= size_.y)
+			{
+				renderRegion(textures_[front_], viewport);
+				valid_ = true;
+				has_dirty_ = false;
+			}
+			else if (delta.x != 0 or delta.y != 0)
+			{
+				sf::RenderTexture& back = textures_[1 - front_];
+
+				// move the pixels that stay visible, then fill in what scrolled in
+				sf::Sprite shifted(textures_[front_].getTexture());
+				shifted.setPosition(-delta.x, -delta.y);
+				back.draw(shifted, sf::BlendNone);
+
+				if (delta.y > 0)
+				{
+					renderRegion(back, { 0, size_.y - delta.y, size_.x, delta.y });
+				}
+				else if (delta.y < 0)
+				{
+					renderRegion(back, { 0, 0, size_.x, -delta.y });
+				}
+
+				if (delta.x > 0)
+				{
+					renderRegion(back, { size_.x - delta.x, 0, delta.x, size_.y });
+				}
+				else if (delta.x < 0)
+				{
+					renderRegion(back, { 0, 0, -delta.x, size_.y });
+				}
+
+				front_ = 1 - front_;
+			}
+
+			if (has_dirty_)
+			{
+				sf::FloatRect dirty(dirty_.left - scroll_.x, dirty_.top - scroll_.y, dirty_.width, dirty_.height);
+				sf::FloatRect region;
+				if (dirty.intersects(viewport, region))
+				{
+					// whole pixels, so the redrawn patch lines up with its surroundings
+					float left = std::floor(region.left);
+					float top = std::floor(region.top);
+					region = sf::FloatRect(left, top, std::ceil(region.left + region.width) - left, std::ceil(region.top + region.height) - top);
+					renderRegion(textures_[front_], region);
+				}
+				has_dirty_ = false;
+			}
+
+			textures_[front_].display();
+			rendered_scroll_ = scroll_;
+		}
+
+	protected:
+
+		void update() const override
+		{
+			markDrawn();
+			updateContent();
+		}
+
+		// Children live in content space, and only the viewport shows them.
+		bool toChildSpace(sf::Vector2f& point) const override
+		{
+			bool inside = sf::FloatRect(position_, size_).contains(point);
+			point = point - position_ + scroll_;
+			return inside;
+		}
+
+		void fromChildSpace(sf::Vector2f& point) const override
+		{
+			point = point + position_ - scroll_;
+		}
+
+		// Scrolls for content that did not use the wheel itself.
+		void pointerEvent(PointerEvent& event) override
+		{
+			if (event.type == PointerEventType::Wheel and event.phase != PointerPhase::Capture)
+			{
+				scrollBy(-event.delta * wheel_step);
+				event.stopPropagation();
+			}
+		}
+
+		sf::Vector2f measureContent(sf::Vector2f) override
+		{
+			return size_;
+		}
+
+		void arrangeContent() override
+		{
+			if (content() != nullptr)
+			{
+				sf::FloatRect previous = content()->getBounds();
+				sf::Vector2f size = content()->measure({ size_.x, unconstrained.y });
+				content()->arrange({ 0, 0 }, size);
+
+				// changes inside the content report their own redraws; a new
+				// viewport size recreates the textures in render()
+				if (content()->getBounds() != previous)
+				{
+					valid_ = false;
+				}
+			}
+
+			setScrollOffset(scroll_);
+		}
+
+		void childRedrawRequested(const sf::FloatRect& area) override
+		{
+			if (!overlaps(visibleArea(), area))
+			{
+				return;
+			}
+
+			if (has_dirty_)
+			{
+				float left = std::min(dirty_.left, area.left);
+				float top = std::min(dirty_.top, area.top);
+				float right = std::max(dirty_.left + dirty_.width, area.left + area.width);
+				float bottom = std::max(dirty_.top + dirty_.height, area.top + area.height);
+				dirty_ = sf::FloatRect(left, top, right - left, bottom - top);
+			}
+			else
+			{
+				dirty_ = area;
+				has_dirty_ = true;
+			}
+
+			requestRedraw();
+		}
+
+	public:
+
+		ScrollView(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window) :
+			Container(window),
+			front_(0),
+			scroll_({ 0, 0 }),
+			rendered_scroll_({ 0, 0 }),
+			valid_(false),
+			has_dirty_(false),
+			background_(sf::Color::Black)
+		{
+			position_ = position;
+			setSize(size);
+			subscribe(PointerCategory::Wheel);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			ScrollView* self = const_cast<ScrollView*>(this);
+
+			if (layout_dirty_ or arrange_dirty_)
+			{
+				self->updateLayout();
+			}
+
+			if (!visibility or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			// before the content, which is on top of it
+			markDrawn();
+			updateContent();
+			self->render();
+
+			sprite_.setTexture(textures_[front_].getTexture(), true);
+			sprite_.setPosition(position_);
+			target.draw(sprite_, animation_state);
+		}
+
+		// The content is rendered into the texture untransformed, so its
+		// space starts over at the scroll view.
+		const sf::Transform& getWorldTransform() const override
+		{
+			return sf::Transform::Identity;
+		}
+
+		const sf::Transform& getInverseWorldTransform() const override
+		{
+			return sf::Transform::Identity;
+		}
+
+		// Replaces the content; the previous one is deleted.
+		void setContent(Component* content)
+		{
+			while (!children_.empty())
+			{
+				delete removeChild(children_.back());
+			}
+
+			if (content != nullptr)
+			{
+				addChild(content);
+			}
+
+			scroll_ = { 0, 0 };
+			valid_ = false;
+		}
+
+		Component* getContent() const
+		{
+			return content();
+		}
+
+		void scrollBy(sf::Vector2f delta)
+		{
+			setScrollOffset(scroll_ + delta);
+		}
+
+		// Offsets are kept in whole pixels so shifted pixels stay sharp.
+		void setScrollOffset(sf::Vector2f offset)
+		{
+			sf::Vector2f limit = maxScroll();
+			offset.x = std::round(std::clamp(offset.x, 0.0f, limit.x));
+			offset.y = std::round(std::clamp(offset.y, 0.0f, limit.y));
+
+			if (offset != scroll_)
+			{
+				scroll_ = offset;
+				requestRedraw();
+			}
+		}
+
+		sf::Vector2f getScrollOffset() const
+		{
+			return scroll_;
+		}
+
+		void setBackground(sf::Color color)
+		{
+			background_ = color;
+			valid_ = false;
+			requestRedraw();
+		}
+
+		// Forces the next draw to render everything, e.g. after changing
+		// content that does not report its own redraws.
+		void invalidate()
+		{
+			valid_ = false;
+			requestRedraw();
+		}
+
+	};
+}
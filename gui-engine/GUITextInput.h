@@ -0,0 +1,814 @@
+#pragma once
+
+#include "GUICore.h"
+#include <vector>
+#include <cmath>
+
+namespace gui
+{
+	// Sequence with a hole at the last edit point. Typing at one place only
+	// fills the hole; the elements in between move only when the edit point
+	// jumps, so the cost follows the caret, not the size of the text.
+	template <typename T>
+	class GapBuffer
+	{
+	private:
+
+		std::vector<T> data_;
+		std::size_t gap_start_;
+		std::size_t gap_end_;
+
+		void moveGap(std::size_t index)
+		{
+			if (index < gap_start_)
+			{
+				std::move_backward(data_.begin() + index, data_.begin() + gap_start_, data_.begin() + gap_end_);
+				gap_end_ -= gap_start_ - index;
+				gap_start_ = index;
+			}
+			else if (index > gap_start_)
+			{
+				std::size_t count = index - gap_start_;
+				std::move(data_.begin() + gap_end_, data_.begin() + gap_end_ + count, data_.begin() + gap_start_);
+				gap_start_ += count;
+				gap_end_ += count;
+			}
+		}
+
+		void reserveGap(std::size_t count)
+		{
+			if (gap_end_ - gap_start_ >= count)
+			{
+				return;
+			}
+
+			std::size_t tail = data_.size() - gap_end_;
+			std::size_t capacity = std::max(data_.size() * 2, size() + count + 64);
+
+			std::vector<T> data(capacity);
+			std::move(data_.begin(), data_.begin() + gap_start_, data.begin());
+			std::move(data_.begin() + gap_end_, data_.end(), data.end() - tail);
+			data_.swap(data);
+			gap_end_ = data_.size() - tail;
+		}
+
+	public:
+
+		GapBuffer() :
+			gap_start_(0),
+			gap_end_(0)
+		{
+
+		}
+
+		std::size_t size() const
+		{
+			return data_.size() - (gap_end_ - gap_start_);
+		}
+
+		T operator[](std::size_t index) const
+		{
+			return index < gap_start_ ? data_[index] : data_[index + gap_end_ - gap_start_];
+		}
+
+		void insert(std::size_t index, const T* values, std::size_t count)
+		{
+			moveGap(index);
+			reserveGap(count);
+			std::copy_n(values, count, data_.begin() + gap_start_);
+			gap_start_ += count;
+		}
+
+		void erase(std::size_t index, std::size_t count)
+		{
+			moveGap(index);
+			gap_end_ += count;
+		}
+
+		// Copies `count` elements from `index` on, across the gap if needed.
+		void copy(std::size_t index, std::size_t count, T* out) const
+		{
+			if (index < gap_start_)
+			{
+				std::size_t before = std::min(count, gap_start_ - index);
+				out = std::copy_n(data_.begin() + index, before, out);
+				index += before;
+				count -= before;
+			}
+			std::copy_n(data_.begin() + index + gap_end_ - gap_start_, count, out);
+		}
+
+		void clear()
+		{
+			gap_start_ = 0;
+			gap_end_ = data_.size();
+		}
+
+	};
+
+	// Editable text, one line or many. The text sits in a gap buffer next to
+	// an index of line starts. Lines are laid out into glyph quads once and
+	// kept for the rows in view, so a keystroke lays out only the line it
+	// touched; selection, glyphs and caret all go out in one draw.
+	class TextInput : public Component, public IAssetListener
+	{
+	private:
+
+		static constexpr std::size_t unbound = static_cast<std::size_t>(-1);
+		static constexpr float padding = 4;
+
+		struct LineLayout
+		{
+			sf::VertexArray vertices;
+			// caret x before each codepoint and after the last
+			std::vector<float> stops;
+			std::size_t line = unbound;
+		};
+
+		AssetLoader::Font font_;
+		mutable GlyphBatch batch_;
+		mutable bool batch_dirty_;
+
+		GapBuffer<sf::Uint32> buffer_;
+		std::vector<std::size_t> line_starts_;
+
+		std::vector<sf::Uint32> input_;
+		std::vector<std::size_t> starts_;
+
+		// line i is laid out into cache_[i % cache_.size()], like ListView's rows
+		mutable std::vector<LineLayout> cache_;
+		mutable std::vector<sf::Uint32> scratch_;
+
+		bool multiline_;
+		unsigned int font_size_;
+		float line_height_;
+
+		std::size_t caret_;
+		std::size_t anchor_;
+		// kept while moving up and down so the caret returns to its column
+		float preferred_x_;
+
+		float scroll_x_;
+		double scroll_y_;
+
+		sf::Color background_;
+		sf::Color text_color_;
+		sf::Color selection_color_;
+
+		void InitCache()
+		{
+			if (font_->ready)
+			{
+				line_height_ = std::ceil(batch_.getLineSpacing());
+			}
+			else
+			{
+				line_height_ = std::ceil(font_size_ * 1.2f);
+			}
+
+			std::size_t count = static_cast<std::size_t>(std::ceil(size_.y / line_height_)) + 1;
+			cache_.assign(count, LineLayout());
+			batch_dirty_ = true;
+		}
+
+		void invalidateLines()
+		{
+			for (auto& layout : cache_)
+			{
+				layout.line = unbound;
+			}
+		}
+
+		std::size_t lineCount() const
+		{
+			return line_starts_.size();
+		}
+
+		std::size_t lineOf(std::size_t index) const
+		{
+			return static_cast<std::size_t>(std::upper_bound(line_starts_.begin(), line_starts_.end(), index) - line_starts_.begin()) - 1;
+		}
+
+		// Index of the line's newline, or the end of the text on the last line.
+		std::size_t lineEnd(std::size_t line) const
+		{
+			return line + 1 < lineCount() ? line_starts_[line + 1] - 1 : buffer_.size();
+		}
+
+		const LineLayout& layoutLine(std::size_t line) const
+		{
+			LineLayout& layout = cache_[line % cache_.size()];
+			if (layout.line != line)
+			{
+				std::size_t start = line_starts_[line];
+				std::size_t count = lineEnd(line) - start;
+				scratch_.resize(count);
+				buffer_.copy(start, count, scratch_.data());
+				batch_.layout(scratch_.data(), count, text_color_, layout.vertices, layout.stops);
+				layout.line = line;
+			}
+			return layout;
+		}
+
+		float columnX(std::size_t index) const
+		{
+			if (!font_->ready)
+			{
+				return 0;
+			}
+			std::size_t line = lineOf(index);
+			return layoutLine(line).stops[index - line_starts_[line]];
+		}
+
+		// Nearest caret position to `x` on `line`.
+		std::size_t indexAt(std::size_t line, float x) const
+		{
+			std::size_t start = line_starts_[line];
+			if (!font_->ready)
+			{
+				return start;
+			}
+
+			const std::vector<float>& stops = layoutLine(line).stops;
+			std::size_t column = 0;
+			while (column + 1 < stops.size() and x > (stops[column] + stops[column + 1]) / 2)
+			{
+				column++;
+			}
+			return start + column;
+		}
+
+		std::size_t indexAtPoint(sf::Vector2f point) const
+		{
+			double y = point.y - position_.y - padding + scroll_y_;
+			std::size_t line = y <= 0 ? 0 : std::min(static_cast<std::size_t>(y / line_height_), lineCount() - 1);
+			return indexAt(line, point.x - position_.x - padding + scroll_x_);
+		}
+
+		std::size_t firstVisible() const
+		{
+			return static_cast<std::size_t>(scroll_y_ / line_height_);
+		}
+
+		std::size_t visibleLines() const
+		{
+			return std::max<std::size_t>(1, static_cast<std::size_t>((size_.y - 2 * padding) / line_height_));
+		}
+
+		double maxScrollY() const
+		{
+			return std::max(0.0, lineCount() * static_cast<double>(line_height_) - (size_.y - 2 * padding));
+		}
+
+		void ensureCaretVisible()
+		{
+			double top = lineOf(caret_) * static_cast<double>(line_height_);
+			if (top < scroll_y_)
+			{
+				scroll_y_ = top;
+			}
+			else if (top + line_height_ > scroll_y_ + size_.y - 2 * padding)
+			{
+				scroll_y_ = std::min(top + line_height_ - (size_.y - 2 * padding), maxScrollY());
+			}
+
+			float x = columnX(caret_);
+			float width = size_.x - 2 * padding;
+			if (x < scroll_x_)
+			{
+				scroll_x_ = std::max(0.0f, x - width / 4);
+			}
+			else if (x > scroll_x_ + width - 1)
+			{
+				scroll_x_ = x - width + width / 4;
+			}
+		}
+
+		void moveCaret(std::size_t index, bool extend)
+		{
+			caret_ = index;
+			if (!extend)
+			{
+				anchor_ = index;
+			}
+			ensureCaretVisible();
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+		bool hasSelection() const
+		{
+			return caret_ != anchor_;
+		}
+
+		std::size_t selectionStart() const
+		{
+			return std::min(caret_, anchor_);
+		}
+
+		std::size_t selectionEnd() const
+		{
+			return std::max(caret_, anchor_);
+		}
+
+		// Replaces [from, to) with `text`. Only the line starts after the
+		// edit shift; the line's layout is redone when it is next drawn, and
+		// the other cached lines stay unless lines were added or removed.
+		void replace(std::size_t from, std::size_t to, const sf::Uint32* text, std::size_t count)
+		{
+			std::size_t first_line = lineOf(from);
+			std::size_t last_line = lineOf(to);
+
+			buffer_.erase(from, to - from);
+			buffer_.insert(from, text, count);
+
+			std::size_t removed = to - from;
+			for (std::size_t line = last_line + 1; line < lineCount(); line++)
+			{
+				line_starts_[line] = line_starts_[line] - removed + count;
+			}
+
+			starts_.clear();
+			for (std::size_t i = 0; i < count; i++)
+			{
+				if (text[i] == '\n')
+				{
+					starts_.push_back(from + i + 1);
+				}
+			}
+
+			std::size_t added = starts_.size();
+			line_starts_.erase(line_starts_.begin() + first_line + 1, line_starts_.begin() + last_line + 1);
+			line_starts_.insert(line_starts_.begin() + first_line + 1, starts_.begin(), starts_.end());
+
+			if (added > 0 or last_line != first_line)
+			{
+				invalidateLines();
+			}
+			else
+			{
+				cache_[first_line % cache_.size()].line = unbound;
+			}
+
+			scroll_y_ = std::min(scroll_y_, maxScrollY());
+			preferred_x_ = -1;
+			moveCaret(from + count, false);
+			notifyListeners(EventType::TextChanged);
+		}
+
+		void insertText(const sf::Uint32* text, std::size_t count)
+		{
+			input_.clear();
+			for (std::size_t i = 0; i < count; i++)
+			{
+				if (text[i] != '\r' and text[i] != '\n')
+				{
+					input_.push_back(text[i]);
+				}
+				else if (multiline_ and (text[i] == '\n' or i + 1 == count or text[i + 1] != '\n'))
+				{
+					// \r\n and lone \r from the clipboard become \n
+					input_.push_back('\n');
+				}
+			}
+			replace(selectionStart(), selectionEnd(), input_.data(), input_.size());
+		}
+
+		static bool isWordChar(sf::Uint32 codepoint)
+		{
+			return codepoint == '_' or codepoint > 127 or (codepoint >= '0' and codepoint <= '9') or ((codepoint | 0x20) >= 'a' and (codepoint | 0x20) <= 'z');
+		}
+
+		void selectWord(std::size_t index)
+		{
+			std::size_t line = lineOf(index);
+			std::size_t start = line_starts_[line];
+			std::size_t end = lineEnd(line);
+
+			std::size_t from = index;
+			std::size_t to = index;
+			if (index < end and isWordChar(buffer_[index]))
+			{
+				while (from > start and isWordChar(buffer_[from - 1]))
+				{
+					from--;
+				}
+				while (to < end and isWordChar(buffer_[to]))
+				{
+					to++;
+				}
+			}
+			else if (index < end)
+			{
+				to++;
+			}
+
+			anchor_ = from;
+			moveCaret(to, true);
+		}
+
+		void copySelection() const
+		{
+			sf::String string;
+			for (std::size_t i = selectionStart(); i < selectionEnd(); i++)
+			{
+				string += buffer_[i];
+			}
+			sf::Clipboard::setString(string);
+		}
+
+		// Single-line fields leave Up and Down to focus navigation.
+		bool keyEvent(const sf::Event::KeyEvent& key) override
+		{
+			std::size_t line = lineOf(caret_);
+			bool vertical = false;
+
+			switch (key.code)
+			{
+			case sf::Keyboard::Left:
+				if (hasSelection() and !key.shift)
+				{
+					moveCaret(selectionStart(), false);
+				}
+				else if (caret_ > 0)
+				{
+					moveCaret(caret_ - 1, key.shift);
+				}
+				break;
+
+			case sf::Keyboard::Right:
+				if (hasSelection() and !key.shift)
+				{
+					moveCaret(selectionEnd(), false);
+				}
+				else if (caret_ < buffer_.size())
+				{
+					moveCaret(caret_ + 1, key.shift);
+				}
+				break;
+
+			case sf::Keyboard::Up:
+			case sf::Keyboard::Down:
+			case sf::Keyboard::PageUp:
+			case sf::Keyboard::PageDown:
+			{
+				if (!multiline_)
+				{
+					return false;
+				}
+
+				bool up = key.code == sf::Keyboard::Up or key.code == sf::Keyboard::PageUp;
+				std::size_t lines = key.code == sf::Keyboard::Up or key.code == sf::Keyboard::Down ? 1 : visibleLines();
+				std::size_t target = up ? line - std::min(line, lines) : std::min(line + lines, lineCount() - 1);
+
+				if (preferred_x_ < 0)
+				{
+					preferred_x_ = columnX(caret_);
+				}
+				moveCaret(indexAt(target, preferred_x_), key.shift);
+				vertical = true;
+				break;
+			}
+
+			case sf::Keyboard::Home:
+				moveCaret(key.control ? 0 : line_starts_[line], key.shift);
+				break;
+
+			case sf::Keyboard::End:
+				moveCaret(key.control ? buffer_.size() : lineEnd(line), key.shift);
+				break;
+
+			case sf::Keyboard::BackSpace:
+				if (hasSelection())
+				{
+					replace(selectionStart(), selectionEnd(), nullptr, 0);
+				}
+				else if (caret_ > 0)
+				{
+					replace(caret_ - 1, caret_, nullptr, 0);
+				}
+				break;
+
+			case sf::Keyboard::Delete:
+				if (hasSelection())
+				{
+					replace(selectionStart(), selectionEnd(), nullptr, 0);
+				}
+				else if (caret_ < buffer_.size())
+				{
+					replace(caret_, caret_ + 1, nullptr, 0);
+				}
+				break;
+
+			case sf::Keyboard::Enter:
+			{
+				if (!multiline_)
+				{
+					return false;
+				}
+				sf::Uint32 newline = '\n';
+				insertText(&newline, 1);
+				break;
+			}
+
+			case sf::Keyboard::A:
+				if (!key.control)
+				{
+					return false;
+				}
+				anchor_ = 0;
+				moveCaret(buffer_.size(), true);
+				break;
+
+			case sf::Keyboard::C:
+			case sf::Keyboard::X:
+				if (!key.control)
+				{
+					return false;
+				}
+				if (hasSelection())
+				{
+					copySelection();
+					if (key.code == sf::Keyboard::X)
+					{
+						replace(selectionStart(), selectionEnd(), nullptr, 0);
+					}
+				}
+				break;
+
+			case sf::Keyboard::V:
+			{
+				if (!key.control)
+				{
+					return false;
+				}
+				sf::String string = sf::Clipboard::getString();
+				insertText(string.getData(), string.getSize());
+				break;
+			}
+
+			default:
+				return false;
+			}
+
+			if (!vertical)
+			{
+				preferred_x_ = -1;
+			}
+			return true;
+		}
+
+		bool textEvent(sf::Uint32 codepoint) override
+		{
+			// control characters come through KeyPressed instead
+			if (codepoint < 32 or codepoint == 127)
+			{
+				return false;
+			}
+			insertText(&codepoint, 1);
+			return true;
+		}
+
+		void pointerEvent(PointerEvent& event) override
+		{
+			switch (event.type)
+			{
+			case PointerEventType::Press:
+				if (event.button == sf::Mouse::Left and event.phase == PointerPhase::Target)
+				{
+					preferred_x_ = -1;
+					moveCaret(indexAtPoint(event.position), sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) or sf::Keyboard::isKeyPressed(sf::Keyboard::RShift));
+				}
+				break;
+
+			case PointerEventType::Drag:
+				if (event.button == sf::Mouse::Left)
+				{
+					moveCaret(indexAtPoint(event.position), true);
+				}
+				break;
+
+			case PointerEventType::DoubleClick:
+				if (event.button == sf::Mouse::Left)
+				{
+					selectWord(indexAtPoint(event.position));
+				}
+				break;
+
+			case PointerEventType::Wheel:
+				if (multiline_ and event.phase != PointerPhase::Capture)
+				{
+					double offset = std::clamp(scroll_y_ - event.delta.y * wheel_step, 0.0, maxScrollY());
+					if (offset != scroll_y_)
+					{
+						scroll_y_ = offset;
+						batch_dirty_ = true;
+						requestRedraw();
+						event.stopPropagation();
+					}
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		void focusChanged(bool focused) override
+		{
+			batch_dirty_ = true;
+			Component::focusChanged(focused);
+		}
+
+		void assetReady() override
+		{
+			batch_.setFont(font_->font);
+			InitCache();
+			requestRedraw();
+		}
+
+		void rebuildBatch() const
+		{
+			batch_.clear();
+			batch_.appendRect(sf::FloatRect(position_, size_), background_);
+
+			std::size_t first = firstVisible();
+			std::size_t last = std::min(first + cache_.size(), lineCount());
+			float left = position_.x + padding - scroll_x_;
+
+			std::size_t selection_start = selectionStart();
+			std::size_t selection_end = selectionEnd();
+			// a selected newline shows as a sliver past the end of its line
+			float newline_width = batch_.getAdvance(' ');
+
+			for (std::size_t line = first; line < last; line++)
+			{
+				float y = position_.y + padding + static_cast<float>(line * static_cast<double>(line_height_) - scroll_y_);
+				const LineLayout& layout = layoutLine(line);
+
+				std::size_t start = line_starts_[line];
+				std::size_t end = lineEnd(line);
+				if (selection_start < selection_end and selection_start <= end and selection_end > start)
+				{
+					float from = layout.stops[std::max(selection_start, start) - start];
+					float to = layout.stops[std::min(selection_end, end) - start];
+					if (selection_end > end)
+					{
+						to += newline_width;
+					}
+					batch_.appendRect({ left + from, y, to - from, line_height_ }, selection_color_);
+				}
+
+				batch_.append(layout.vertices, { left, y });
+
+				if (hasFocus() and caret_ >= start and caret_ <= end)
+				{
+					batch_.appendRect({ std::floor(left + layout.stops[caret_ - start]), y, 1, line_height_ }, text_color_);
+				}
+			}
+		}
+
+	public:
+
+		TextInput(sf::Vector2f position, sf::Vector2f size, sf::RenderWindow* window, bool multiline = false) :
+			Component(position, size, window),
+			batch_dirty_(true),
+			line_starts_(1, 0),
+			multiline_(multiline),
+			font_size_(20),
+			line_height_(24),
+			caret_(0),
+			anchor_(0),
+			preferred_x_(-1),
+			scroll_x_(0),
+			scroll_y_(0),
+			background_(30, 30, 30),
+			text_color_(sf::Color::White),
+			selection_color_(60, 90, 160)
+		{
+			font_ = AssetLoader::get().loadFont("res/font.ttf");
+			batch_.setCharacterSize(font_size_);
+			if (font_->ready)
+			{
+				batch_.setFont(font_->font);
+			}
+
+			InitCache();
+			font_->addListener(this);
+			subscribe(PointerCategory::Button | PointerCategory::Drag | PointerCategory::DoubleClick | PointerCategory::Wheel);
+			setFocusable(true);
+		}
+
+		~TextInput() override
+		{
+			font_->removeListener(this);
+		}
+
+		void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+		{
+			// the batch needs the font even for its plain rects
+			if (!visibility or !font_->ready or isCulled(target, animation_state))
+			{
+				return;
+			}
+
+			Component::update();
+
+			if (batch_dirty_)
+			{
+				rebuildBatch();
+				batch_dirty_ = false;
+			}
+
+			sf::View previous = target.getView();
+			target.setView(clipView(target, animation_state.transform.transformRect(getBounds())));
+			target.draw(batch_, animation_state);
+			drawFocus(target, animation_state);
+			target.setView(previous);
+		}
+
+		void setPosition(const sf::Vector2f position) override
+		{
+			Component::setPosition(position);
+			batch_dirty_ = true;
+		}
+
+		void setText(std::string_view text)
+		{
+			sf::String string;
+			utf8::decode(text, string);
+
+			buffer_.clear();
+			line_starts_.assign(1, 0);
+			invalidateLines();
+			caret_ = 0;
+			anchor_ = 0;
+			scroll_x_ = 0;
+			scroll_y_ = 0;
+			insertText(string.getData(), string.getSize());
+		}
+
+		std::string getText() const
+		{
+			std::string text;
+			text.reserve(buffer_.size());
+			for (std::size_t i = 0; i < buffer_.size(); i++)
+			{
+				utf8::append(text, buffer_[i]);
+			}
+			return text;
+		}
+
+		std::size_t getLength() const
+		{
+			return buffer_.size();
+		}
+
+		std::size_t getLineCount() const
+		{
+			return lineCount();
+		}
+
+		bool isMultiline() const
+		{
+			return multiline_;
+		}
+
+		// Caret and selection anchor as codepoint indices.
+		void setSelection(std::size_t anchor, std::size_t caret)
+		{
+			anchor_ = std::min(anchor, buffer_.size());
+			preferred_x_ = -1;
+			moveCaret(std::min(caret, buffer_.size()), true);
+		}
+
+		std::size_t getCaret() const
+		{
+			return caret_;
+		}
+
+		std::size_t getAnchor() const
+		{
+			return anchor_;
+		}
+
+		void setFontSize(unsigned int size)
+		{
+			font_size_ = size;
+			batch_.setCharacterSize(size);
+			InitCache();
+			requestRedraw();
+		}
+
+		void setColor(sf::Color background, sf::Color text, sf::Color selection)
+		{
+			background_ = background;
+			text_color_ = text;
+			selection_color_ = selection;
+			invalidateLines();
+			batch_dirty_ = true;
+			requestRedraw();
+		}
+
+	};
+}
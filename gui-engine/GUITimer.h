@@ -0,0 +1,334 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <functional>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+namespace gui
+{
+	struct TimerId
+	{
+		std::uint32_t index = std::numeric_limits<std::uint32_t>::max();
+		std::uint32_t generation = 0;
+	};
+
+	// Hierarchical timing wheel with millisecond ticks. Four levels of 64
+	// slots cover about 4.6 hours directly; later timers wait on the top
+	// level and are re-sorted as it turns. Timers sit in intrusive lists, so
+	// adding and cancelling are O(1), and an occupancy mask per level lets
+	// advance() skip empty stretches instead of visiting every tick.
+	class TimerWheel
+	{
+	private:
+
+		static constexpr std::uint32_t level_bits = 6;
+		static constexpr std::uint32_t level_slots = 1 << level_bits;
+		static constexpr std::uint32_t level_count = 4;
+		static constexpr std::uint32_t slot_mask = level_slots - 1;
+
+		static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+		// list of the timers being fired right now
+		static constexpr std::uint32_t firing = level_count * level_slots;
+
+		struct Node
+		{
+			std::function<void()> callback;
+			std::uint64_t expires;
+			std::uint32_t interval;
+			std::uint32_t generation;
+			std::uint32_t list;
+			std::uint32_t prev;
+			std::uint32_t next;
+			bool active;
+		};
+
+		std::vector<Node> nodes_;
+		std::vector<std::uint32_t> free_;
+
+		std::array<std::uint32_t, level_count * level_slots + 1> heads_;
+		std::array<std::uint64_t, level_count> occupied_;
+
+		std::uint64_t now_;
+		double remainder_;
+		std::size_t count_;
+
+		void link(std::uint32_t index, std::uint32_t list)
+		{
+			Node& node = nodes_[index];
+			node.list = list;
+			node.prev = none;
+			node.next = heads_[list];
+			if (node.next != none)
+			{
+				nodes_[node.next].prev = index;
+			}
+			heads_[list] = index;
+
+			if (list != firing)
+			{
+				occupied_[list / level_slots] |= std::uint64_t(1) << (list % level_slots);
+			}
+		}
+
+		void unlink(std::uint32_t index)
+		{
+			Node& node = nodes_[index];
+			if (node.prev != none)
+			{
+				nodes_[node.prev].next = node.next;
+			}
+			else
+			{
+				heads_[node.list] = node.next;
+			}
+			if (node.next != none)
+			{
+				nodes_[node.next].prev = node.prev;
+			}
+
+			if (node.list != firing and heads_[node.list] == none)
+			{
+				occupied_[node.list / level_slots] &= ~(std::uint64_t(1) << (node.list % level_slots));
+			}
+			node.list = none;
+		}
+
+		// Files the timer under the level whose span covers its delay.
+		void schedule(std::uint32_t index)
+		{
+			std::uint64_t expires = nodes_[index].expires;
+			std::uint64_t delta = expires > now_ ? expires - now_ : 0;
+
+			for (std::uint32_t level = 0; level < level_count; level++)
+			{
+				std::uint32_t shift = level * level_bits;
+				if (delta < (std::uint64_t(1) << (shift + level_bits)) or level == level_count - 1)
+				{
+					if (delta >= (std::uint64_t(1) << (shift + level_bits)))
+					{
+						// beyond the wheel; parks one turn ahead and comes back
+						expires = now_ + (std::uint64_t(1) << (shift + level_bits)) - 1;
+					}
+					else if (delta == 0)
+					{
+						expires = now_;
+					}
+					link(index, level * level_slots + std::uint32_t((expires >> shift) & slot_mask));
+					return;
+				}
+			}
+		}
+
+		// Moves the timers of one upper slot down to finer levels.
+		void cascade(std::uint32_t level)
+		{
+			std::uint32_t list = level * level_slots + std::uint32_t((now_ >> (level * level_bits)) & slot_mask);
+			while (heads_[list] != none)
+			{
+				std::uint32_t index = heads_[list];
+				unlink(index);
+				schedule(index);
+			}
+		}
+
+		void release(std::uint32_t index)
+		{
+			Node& node = nodes_[index];
+			node.callback = nullptr;
+			node.active = false;
+			node.generation++;
+			free_.push_back(index);
+			count_--;
+		}
+
+		void fire()
+		{
+			std::uint32_t list = std::uint32_t(now_ & slot_mask);
+			if (heads_[list] == none)
+			{
+				return;
+			}
+
+			// callbacks may add or cancel timers, so the slot is emptied first
+			while (heads_[list] != none)
+			{
+				std::uint32_t index = heads_[list];
+				unlink(index);
+				link(index, firing);
+			}
+
+			while (heads_[firing] != none)
+			{
+				std::uint32_t index = heads_[firing];
+				unlink(index);
+
+				// nodes_ can grow inside the callback
+				std::function<void()> callback = std::move(nodes_[index].callback);
+				callback();
+
+				Node& node = nodes_[index];
+				if (!node.active)
+				{
+					// cancelled from inside its own callback
+					free_.push_back(index);
+				}
+				else if (node.expires > now_)
+				{
+					// restarted from inside its own callback
+					node.callback = std::move(callback);
+					schedule(index);
+				}
+				else if (node.interval > 0)
+				{
+					node.callback = std::move(callback);
+					node.expires = std::max(node.expires + node.interval, now_ + 1);
+					schedule(index);
+				}
+				else
+				{
+					release(index);
+				}
+			}
+		}
+
+	public:
+
+		TimerWheel() :
+			occupied_(),
+			now_(0),
+			remainder_(0),
+			count_(0)
+		{
+			heads_.fill(none);
+		}
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		// Calls `callback` after `milliseconds`, and then every `interval`
+		// milliseconds if that is not 0.
+		TimerId add(std::uint32_t milliseconds, std::function<void()> callback, std::uint32_t interval = 0)
+		{
+			std::uint32_t index;
+			if (!free_.empty())
+			{
+				index = free_.back();
+				free_.pop_back();
+			}
+			else
+			{
+				index = std::uint32_t(nodes_.size());
+				nodes_.push_back({ nullptr, 0, 0, 0, none, none, none, false });
+			}
+
+			Node& node = nodes_[index];
+			node.callback = std::move(callback);
+			node.expires = now_ + std::max<std::uint32_t>(milliseconds, 1);
+			node.interval = interval;
+			node.active = true;
+			schedule(index);
+			count_++;
+
+			return { index, node.generation };
+		}
+
+		bool isActive(TimerId id) const
+		{
+			return id.index < nodes_.size() and nodes_[id.index].active and nodes_[id.index].generation == id.generation;
+		}
+
+		bool cancel(TimerId id)
+		{
+			if (!isActive(id))
+			{
+				return false;
+			}
+
+			Node& node = nodes_[id.index];
+			if (node.list != none)
+			{
+				unlink(id.index);
+				release(id.index);
+			}
+			else
+			{
+				// it is running; fire() frees it once the callback returns
+				node.active = false;
+				node.generation++;
+				count_--;
+			}
+			return true;
+		}
+
+		// Pushes the deadline back to `milliseconds` from now, which is all
+		// a debounce needs.
+		bool restart(TimerId id, std::uint32_t milliseconds)
+		{
+			if (!isActive(id))
+			{
+				return false;
+			}
+
+			Node& node = nodes_[id.index];
+			node.expires = now_ + std::max<std::uint32_t>(milliseconds, 1);
+			if (node.list != none)
+			{
+				unlink(id.index);
+				schedule(id.index);
+			}
+			return true;
+		}
+
+		// Moves time forward and runs every callback that came due, in
+		// order of their ticks.
+		void advance(float seconds)
+		{
+			remainder_ += seconds * 1000.0;
+			std::uint64_t ticks = std::uint64_t(remainder_);
+			remainder_ -= double(ticks);
+
+			std::uint64_t target = now_ + ticks;
+			if (count_ == 0)
+			{
+				now_ = target;
+				return;
+			}
+
+			while (now_ < target)
+			{
+				std::uint64_t next = now_ + 1;
+				if ((next & slot_mask) != 0 and (occupied_[0] >> (next & slot_mask)) == 0)
+				{
+					// nothing in the lowest level before the next cascade
+					std::uint64_t boundary = (now_ | slot_mask) + 1;
+					if (boundary > target)
+					{
+						now_ = target;
+						break;
+					}
+					next = boundary;
+				}
+				now_ = next;
+
+				for (std::uint32_t level = 1; level < level_count; level++)
+				{
+					if (((now_ >> ((level - 1) * level_bits)) & slot_mask) != 0)
+					{
+						break;
+					}
+					cascade(level);
+				}
+				fire();
+			}
+		}
+
+		std::size_t getCount() const
+		{
+			return count_;
+		}
+
+	};
+}
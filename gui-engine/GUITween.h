@@ -0,0 +1,461 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
+#include <initializer_list>
+#include <functional>
+#include <cstdint>
+
+namespace gui
+{
+	enum class TweenChannel : std::uint8_t
+	{
+		Position,
+		Size,
+		Color,
+		Opacity,
+		Progress
+	};
+
+	enum class Easing : std::uint8_t
+	{
+		Linear,
+		QuadIn,
+		QuadOut,
+		QuadInOut,
+		CubicIn,
+		CubicOut,
+		CubicInOut,
+		BackOut
+	};
+
+	struct TweenHandle
+	{
+		std::uint32_t slot = static_cast<std::uint32_t>(-1);
+		std::uint32_t generation = 0;
+	};
+
+	// Anything a tween can drive. A channel holds up to four floats
+	// (position and size take two, colors four, opacity and progress one).
+	class ITweenTarget
+	{
+	private:
+
+		friend class TweenSystem;
+
+		std::uint32_t tweens_ = 0;
+
+	protected:
+
+		ITweenTarget()
+		{
+
+		}
+
+		ITweenTarget(const ITweenTarget&)
+		{
+
+		}
+
+		ITweenTarget& operator=(const ITweenTarget&)
+		{
+			return *this;
+		}
+
+		// Running tweens are cancelled so they never write to a dead target.
+		~ITweenTarget();
+
+	public:
+
+		// Writes the channel's current value and returns how many floats it
+		// has, or 0 when the channel is not animatable here.
+		virtual int getTweenValue(TweenChannel, float*) const
+		{
+			return 0;
+		}
+
+		virtual void setTweenValue(TweenChannel, const float*)
+		{
+
+		}
+
+	};
+
+	// Runs every active tween in one pass per frame. Tweens are stored as
+	// structure-of-arrays blocks, one block per easing, so time, easing and
+	// interpolation are plain loops over contiguous floats; only the final
+	// write into the target is a call per tween. With nothing animating,
+	// update() returns straight away.
+	class TweenSystem
+	{
+	private:
+
+		static constexpr std::size_t easing_count = static_cast<std::size_t>(Easing::BackOut) + 1;
+
+		struct Block
+		{
+			std::vector<float> start;
+			std::vector<float> duration;
+			std::array<std::vector<float>, 4> from;
+			std::array<std::vector<float>, 4> delta;
+			std::vector<ITweenTarget*> target;
+			std::vector<TweenChannel> channel;
+			std::vector<std::uint32_t> slot;
+
+			// per-frame scratch
+			std::vector<float> eased;
+			std::array<std::vector<float>, 4> value;
+
+			std::size_t size() const
+			{
+				return start.size();
+			}
+		};
+
+		struct Slot
+		{
+			std::uint32_t block;
+			std::uint32_t index;
+			std::uint32_t generation;
+			bool used;
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(const std::pair<const ITweenTarget*, TweenChannel>& key) const
+			{
+				return std::hash<const void*>()(key.first) ^ static_cast<std::size_t>(key.second);
+			}
+		};
+
+		std::array<Block, easing_count> blocks_;
+		std::vector<Slot> slots_;
+		std::vector<std::uint32_t> free_slots_;
+
+		// one tween per target and channel; a new one takes over from the old
+		std::unordered_map<std::pair<const ITweenTarget*, TweenChannel>, std::uint32_t, KeyHash> active_;
+
+		std::size_t count_;
+		float time_;
+
+		TweenSystem() :
+			count_(0),
+			time_(0)
+		{
+
+		}
+
+		static void ease(Easing easing, float* t, std::size_t n)
+		{
+			switch (easing)
+			{
+			case Easing::Linear:
+				break;
+
+			case Easing::QuadIn:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					t[i] = t[i] * t[i];
+				}
+				break;
+
+			case Easing::QuadOut:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					t[i] = t[i] * (2 - t[i]);
+				}
+				break;
+
+			case Easing::QuadInOut:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					float u = 1 - t[i];
+					t[i] = t[i] < 0.5f ? 2 * t[i] * t[i] : 1 - 2 * u * u;
+				}
+				break;
+
+			case Easing::CubicIn:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					t[i] = t[i] * t[i] * t[i];
+				}
+				break;
+
+			case Easing::CubicOut:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					float u = 1 - t[i];
+					t[i] = 1 - u * u * u;
+				}
+				break;
+
+			case Easing::CubicInOut:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					float u = 1 - t[i];
+					t[i] = t[i] < 0.5f ? 4 * t[i] * t[i] * t[i] : 1 - 4 * u * u * u;
+				}
+				break;
+
+			case Easing::BackOut:
+				for (std::size_t i = 0; i < n; i++)
+				{
+					// overshoots by about 10% before settling
+					float u = t[i] - 1;
+					t[i] = 1 + u * u * (2.70158f * u + 1.70158f);
+				}
+				break;
+			}
+		}
+
+		// Swap-removes entry `index` of `block`, fixing up the moved entry.
+		void remove(std::uint32_t block_index, std::size_t index)
+		{
+			Block& block = blocks_[block_index];
+			std::size_t last = block.size() - 1;
+
+			ITweenTarget* target = block.target[index];
+			target->tweens_--;
+			active_.erase({ target, block.channel[index] });
+
+			std::uint32_t slot = block.slot[index];
+			slots_[slot].used = false;
+			slots_[slot].generation++;
+			free_slots_.push_back(slot);
+
+			if (index != last)
+			{
+				block.start[index] = block.start[last];
+				block.duration[index] = block.duration[last];
+				for (std::size_t c = 0; c < 4; c++)
+				{
+					block.from[c][index] = block.from[c][last];
+					block.delta[c][index] = block.delta[c][last];
+				}
+				block.target[index] = block.target[last];
+				block.channel[index] = block.channel[last];
+				block.slot[index] = block.slot[last];
+				slots_[block.slot[index]].index = static_cast<std::uint32_t>(index);
+			}
+
+			block.start.pop_back();
+			block.duration.pop_back();
+			for (std::size_t c = 0; c < 4; c++)
+			{
+				block.from[c].pop_back();
+				block.delta[c].pop_back();
+			}
+			block.target.pop_back();
+			block.channel.pop_back();
+			block.slot.pop_back();
+
+			count_--;
+		}
+
+		void updateBlock(std::uint32_t block_index, float now)
+		{
+			Block& block = blocks_[block_index];
+			std::size_t n = block.size();
+
+			block.eased.resize(n);
+			float* t = block.eased.data();
+			const float* start = block.start.data();
+			const float* duration = block.duration.data();
+
+			for (std::size_t i = 0; i < n; i++)
+			{
+				t[i] = std::clamp((now - start[i]) / duration[i], 0.0f, 1.0f);
+			}
+
+			ease(static_cast<Easing>(block_index), t, n);
+
+			for (std::size_t c = 0; c < 4; c++)
+			{
+				block.value[c].resize(n);
+				float* value = block.value[c].data();
+				const float* from = block.from[c].data();
+				const float* delta = block.delta[c].data();
+
+				for (std::size_t i = 0; i < n; i++)
+				{
+					value[i] = from[i] + delta[i] * t[i];
+				}
+			}
+
+			for (std::size_t i = 0; i < n; i++)
+			{
+				if (now >= start[i])
+				{
+					float value[4] = { block.value[0][i], block.value[1][i], block.value[2][i], block.value[3][i] };
+					block.target[i]->setTweenValue(block.channel[i], value);
+				}
+			}
+
+			// finished ones go last, backwards so swap-remove skips nothing
+			for (std::size_t i = n; i-- > 0;)
+			{
+				if (now >= block.start[i] + block.duration[i])
+				{
+					remove(block_index, i);
+				}
+			}
+		}
+
+	public:
+
+		static TweenSystem& get()
+		{
+			static TweenSystem system;
+			return system;
+		}
+
+		// Animates `channel` of `target` from its current value to `to` over
+		// `duration` seconds, starting after `delay`. Replaces a tween
+		// already running on the same channel, so retargeting mid-way is
+		// smooth. Channels the target cannot read are left alone.
+		TweenHandle animate(ITweenTarget* target, TweenChannel channel, std::initializer_list<float> to, float duration, Easing easing = Easing::QuadOut, float delay = 0)
+		{
+			float from[4] = {};
+			int width = target->getTweenValue(channel, from);
+			if (width == 0)
+			{
+				return TweenHandle();
+			}
+
+			auto it = active_.find({ target, channel });
+			if (it != active_.end())
+			{
+				const Slot& slot = slots_[it->second];
+				remove(slot.block, slot.index);
+			}
+
+			if (duration <= 0 and delay <= 0)
+			{
+				float value[4] = {};
+				std::copy_n(to.begin(), std::min<std::size_t>(to.size(), 4), value);
+				target->setTweenValue(channel, value);
+				return TweenHandle();
+			}
+
+			std::uint32_t slot;
+			if (!free_slots_.empty())
+			{
+				slot = free_slots_.back();
+				free_slots_.pop_back();
+			}
+			else
+			{
+				slot = static_cast<std::uint32_t>(slots_.size());
+				slots_.push_back({ 0, 0, 0, false });
+			}
+
+			std::uint32_t block_index = static_cast<std::uint32_t>(easing);
+			Block& block = blocks_[block_index];
+
+			block.start.push_back(time_ + delay);
+			block.duration.push_back(std::max(duration, 1e-6f));
+			for (std::size_t c = 0; c < 4; c++)
+			{
+				float end = c < to.size() ? to.begin()[c] : from[c];
+				block.from[c].push_back(from[c]);
+				block.delta[c].push_back(end - from[c]);
+			}
+			block.target.push_back(target);
+			block.channel.push_back(channel);
+			block.slot.push_back(slot);
+
+			slots_[slot] = { block_index, static_cast<std::uint32_t>(block.size() - 1), slots_[slot].generation, true };
+			active_[{ target, channel }] = slot;
+			target->tweens_++;
+			count_++;
+
+			return { slot, slots_[slot].generation };
+		}
+
+		bool isActive(TweenHandle handle) const
+		{
+			return handle.slot < slots_.size() and slots_[handle.slot].used and slots_[handle.slot].generation == handle.generation;
+		}
+
+		// Stops the tween where it is.
+		void cancel(TweenHandle handle)
+		{
+			if (isActive(handle))
+			{
+				remove(slots_[handle.slot].block, slots_[handle.slot].index);
+			}
+		}
+
+		void cancel(const ITweenTarget* target, TweenChannel channel)
+		{
+			auto it = active_.find({ target, channel });
+			if (it != active_.end())
+			{
+				remove(slots_[it->second].block, slots_[it->second].index);
+			}
+		}
+
+		void cancelAll(const ITweenTarget* target)
+		{
+			for (std::uint32_t b = 0; b < blocks_.size() and target->tweens_ > 0; b++)
+			{
+				for (std::size_t i = blocks_[b].size(); i-- > 0;)
+				{
+					if (blocks_[b].target[i] == target)
+					{
+						remove(b, i);
+					}
+				}
+			}
+		}
+
+		// Advances all tweens by `seconds` and writes their values. Tweens are
+		// closed-form in time, so with a fixed-step clock `lead` samples them
+		// at the interpolated render time instead of the last step. Returns
+		// whether anything is still animating.
+		bool update(float seconds, float lead = 0)
+		{
+			if (count_ == 0)
+			{
+				return false;
+			}
+
+			time_ += seconds;
+			for (std::uint32_t b = 0; b < blocks_.size(); b++)
+			{
+				if (blocks_[b].size() > 0)
+				{
+					updateBlock(b, time_ + lead);
+				}
+			}
+
+			if (count_ == 0)
+			{
+				// restart the clock so it never runs out of float precision
+				time_ = 0;
+			}
+			return count_ > 0;
+		}
+
+		bool isAnimating() const
+		{
+			return count_ > 0;
+		}
+
+		std::size_t getCount() const
+		{
+			return count_;
+		}
+
+	};
+
+	inline ITweenTarget::~ITweenTarget()
+	{
+		if (tweens_ > 0)
+		{
+			TweenSystem::get().cancelAll(this);
+		}
+	}
+}
@@ -10,9 +10,6 @@ private:
     gui::TextureButton* btn_;
     gui::ProgressBar* bar_;
     gui::StatusButton* status_;
-    
-    sf::Texture text_;
-    sf::Texture text_2;
 
 public:
 
@@ -33,10 +30,8 @@ public:
 
         btn_->setPosition({ 500, 500 });
  
-        text_.loadFromFile("res/btn_2.png");
-        status_->addTexture(&text_);
-        text_2.loadFromFile("res/btn_1.png");
-        status_->addTexture(&text_2);
+        status_->addTexture(gui::AssetLoader::get().loadTexture("res/btn_2.png"));
+        status_->addTexture(gui::AssetLoader::get().loadTexture("res/btn_1.png"));
 
         status_->setAligment(gui::HorizontalAligment::Left);
         status_->setAligment(gui::VerticalAligment::Bottom);
@@ -71,6 +66,8 @@ public:
 int main()
 {
     sf::RenderWindow window(sf::VideoMode(1280, 720), "SFML works!");
+    gui::Engine engine(&window);
+    engine.setFrameRate(60);
 
     Test test(&window);
 
@@ -79,14 +76,18 @@ int main()
         sf::Event event;
         while (window.pollEvent(event))
         {
+            engine.handleEvent(event);
+
             if (event.type == sf::Event::Closed)
             {
                 window.close();
             }
         }
+        engine.update();
+
         window.clear();
         window.draw(test);
-        window.display();
+        engine.display();
     }
 
     return 0;
@@ -0,0 +1,34 @@
+// Packs images into atlas pages ahead of time:
+//     AtlasPacker <output base> <image>...
+// writes <output base>.atlas and <output base>_<n>.png for
+// gui::TextureAtlas::loadPacked(). Images are keyed by the path given.
+#include <iostream>
+#include "../GUIAtlas.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: AtlasPacker <output base> <image>...\n";
+        return 1;
+    }
+
+    gui::TextureAtlas atlas;
+    for (int i = 2; i < argc; i++)
+    {
+        if (!atlas.load(argv[i]))
+        {
+            std::cerr << "cannot pack " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    if (!atlas.save(argv[1]))
+    {
+        std::cerr << "cannot write " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::cout << argc - 2 << " images in " << atlas.getPageCount() << " pages\n";
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Times layout of a deep tree without opening a window:
+//     LayoutBenchmark [runs]
+// Builds 10 columns of 10 flex rows of 10 boxes of 10 leaves (11,111
+// nodes) and reports a cold layout, a warm one with nothing changed, one
+// after a single leaf grew, and one after the root was resized, with the
+// number of containers each of them arranged. Exits with 1 when the warm
+// layout arranged anything.
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../GUILayout.h"
+
+// Fixed-size leaf that can change its preferred size.
+class Leaf : public gui::Component
+{
+public:
+
+    Leaf(sf::RenderWindow* window) :
+        gui::Component(window)
+    {
+        size_ = { 20, 10 };
+    }
+
+    void draw(sf::RenderTarget& target, sf::RenderStates animation_state) const override
+    {
+
+    }
+
+    void grow()
+    {
+        size_.x += 1;
+        invalidateLayout();
+    }
+};
+
+// Runs what the first draw after a change would run for this container;
+// nested containers are only arranged once their parent gave them a size.
+class Settled
+{
+public:
+
+    static inline std::size_t arranges = 0;
+
+    virtual ~Settled() = default;
+    virtual void settle() = 0;
+};
+
+template <class Box>
+class Bench : public Box, public Settled
+{
+public:
+
+    using Box::Box;
+
+    void settle() override
+    {
+        if (this->layout_dirty_ or this->arrange_dirty_)
+        {
+            this->updateLayout();
+        }
+    }
+
+protected:
+
+    void arrangeContent() override
+    {
+        arranges++;
+        Box::arrangeContent();
+    }
+};
+
+// Parents come before their children, as in a draw.
+static void settle(const std::vector<Settled*>& containers)
+{
+    for (auto container : containers)
+    {
+        container->settle();
+    }
+}
+
+static double milliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = argc > 1 ? std::max(1, std::stoi(argv[1])) : 20;
+
+    // never opened; the tree only keeps the pointer
+    sf::RenderWindow window;
+
+    double cold = 0;
+    double warm = 0;
+    double leaf = 0;
+    double resize = 0;
+    std::size_t nodes = 0;
+
+    // per run; the same tree is built every time
+    std::size_t cold_arranges = 0;
+    std::size_t warm_arranges = 0;
+    std::size_t leaf_arranges = 0;
+    std::size_t resize_arranges = 0;
+
+    for (int run = 0; run < runs; run++)
+    {
+        Bench<gui::FlexBox> root(gui::Orientation::Horizontal, &window);
+        root.setSize({ 1920, 1080 });
+        std::vector<Settled*> containers = { &root };
+        Leaf* changed = nullptr;
+        nodes = 1;
+
+        for (int column = 0; column < 10; column++)
+        {
+            auto* box = new Bench<gui::VerticalBox>(&window);
+            box->setSpacing(2);
+            containers.push_back(box);
+            nodes++;
+
+            for (int row = 0; row < 10; row++)
+            {
+                auto* flex = new Bench<gui::FlexBox>(gui::Orientation::Horizontal, &window);
+                flex->setWrap(true);
+                containers.push_back(flex);
+                nodes++;
+
+                for (int group = 0; group < 10; group++)
+                {
+                    auto* inner = new Bench<gui::HorizontalBox>(&window);
+                    inner->setPadding({ 1, 1 });
+                    containers.push_back(inner);
+                    nodes++;
+
+                    for (int i = 0; i < 10; i++)
+                    {
+                        Leaf* item = new Leaf(&window);
+                        inner->addChild(item);
+                        changed = item;
+                        nodes++;
+                    }
+                    flex->addChild(inner, { 1, 1, -1 });
+                }
+                box->addChild(flex);
+            }
+            root.addChild(box, { 1, 1, -1 });
+        }
+
+        Settled::arranges = 0;
+        auto start = std::chrono::steady_clock::now();
+        settle(containers);
+        auto after_cold = std::chrono::steady_clock::now();
+        cold_arranges = Settled::arranges;
+
+        Settled::arranges = 0;
+        settle(containers);
+        auto after_warm = std::chrono::steady_clock::now();
+        warm_arranges = std::max(warm_arranges, Settled::arranges);
+
+        Settled::arranges = 0;
+        changed->grow();
+        settle(containers);
+        auto after_leaf = std::chrono::steady_clock::now();
+        leaf_arranges = Settled::arranges;
+
+        Settled::arranges = 0;
+        root.setSize({ 1280, 720 });
+        settle(containers);
+        auto after_resize = std::chrono::steady_clock::now();
+        resize_arranges = Settled::arranges;
+
+        cold += milliseconds(after_cold - start);
+        warm += milliseconds(after_warm - after_cold);
+        leaf += milliseconds(after_leaf - after_warm);
+        resize += milliseconds(after_resize - after_leaf);
+    }
+
+    std::cout << nodes << " nodes, average of " << runs << " runs\n";
+    std::cout << "cold layout:   " << cold / runs << " ms, " << cold_arranges << " arranged\n";
+    std::cout << "warm layout:   " << warm / runs << " ms, " << warm_arranges << " arranged\n";
+    std::cout << "one leaf grew: " << leaf / runs << " ms, " << leaf_arranges << " arranged\n";
+    std::cout << "root resized:  " << resize / runs << " ms, " << resize_arranges << " arranged\n";
+
+    // nothing changed, so nothing may be laid out again
+    if (warm_arranges != 0)
+    {
+        std::cerr << "warm layout arranged " << warm_arranges << " containers\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Packs loose assets into one resource pack:
+//     PackResources [--keep-png] <output.pack> <file>...
+// Entries are keyed by the path given, so pack from the working directory
+// the application runs in (e.g. "res/font.ttf"). Images are stored as raw
+// RGBA unless --keep-png is given, trading pack size for skipping PNG
+// inflation at startup.
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "../GUIResourcePack.h"
+
+static bool isImage(const std::string& path)
+{
+    for (const char* extension : { ".png", ".jpg", ".jpeg", ".bmp", ".tga" })
+    {
+        std::size_t length = std::strlen(extension);
+        if (path.size() >= length and path.compare(path.size() - length, length, extension) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    int first = 1;
+    bool keep_png = false;
+    if (argc > 1 and std::string(argv[1]) == "--keep-png")
+    {
+        keep_png = true;
+        first++;
+    }
+
+    if (argc - first < 2)
+    {
+        std::cerr << "usage: PackResources [--keep-png] <output.pack> <file>...\n";
+        return 1;
+    }
+
+    gui::ResourcePackWriter writer;
+    for (int i = first + 1; i < argc; i++)
+    {
+        std::string path = argv[i];
+
+        if (!keep_png and isImage(path))
+        {
+            sf::Image image;
+            if (!image.loadFromFile(path))
+            {
+                std::cerr << "cannot decode " << path << "\n";
+                return 1;
+            }
+            writer.addImage(path, image);
+            continue;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "cannot read " << path << "\n";
+            return 1;
+        }
+        writer.addRaw(path, std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+    }
+
+    if (!writer.save(argv[first]))
+    {
+        std::cerr << "cannot write " << argv[first] << "\n";
+        return 1;
+    }
+
+    std::cout << argc - first - 1 << " files packed into " << argv[first] << "\n";
+    return 0;
+}